@@ -0,0 +1,55 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+// Standard library includes
+#include <string>  // For the command-line option naming a benchmark
+#include <cstddef> // For the size_t record counts
+
+// Function prototypes
+
+/**
+ * @brief Times the Database screen search on count synthetic patients (--bench-search, one million by default).
+ */
+void benchmarkSearch(size_t count);
+
+/**
+ * @brief Times record files in both layouts, count per layout (--bench-layout, 200000 by default).
+ */
+void benchmarkLayout(size_t count);
+
+/**
+ * @brief Times count record saves under each durability policy (--bench-durability, 20000 by default).
+ */
+void benchmarkDurability(size_t count);
+
+/**
+ * @brief Compares the record formats on count synthetic patients (--bench-format, 20000 by default).
+ */
+void benchmarkFormat(size_t count);
+
+/**
+ * @brief Times startup in each storage mode on count synthetic patients (--bench-startup, one million by default).
+ */
+void benchmarkStartup(size_t count);
+
+/**
+ * @brief Measures the memory of one patient's admissions log of count admissions (--bench-admissions, 100000 by default).
+ */
+void benchmarkAdmissions(size_t count);
+
+/**
+ * @brief Checks whether a command-line option selects one of the benchmarks above.
+ * @param option The option, e.g. "--bench-search".
+ * @return true if runBenchmark() accepts it.
+ */
+bool isBenchmarkOption(const std::string &option);
+
+/**
+ * @brief Runs the benchmark an option selects and prints its results.
+ * @param option The option, e.g. "--bench-search".
+ * @param countArg The count argument that followed the option, or nullptr to use the default count.
+ * @return EXIT_SUCCESS once the benchmark ran, or EXIT_FAILURE if the count is not a positive whole number.
+ */
+int runBenchmark(const std::string &option, const char *countArg);
+
+#endif // BENCHMARKS_H
@@ -1,7 +1,8 @@
 #ifndef ADMIN_H
 #define ADMIN_H
 
-#include "User.hpp" // Include base User class for inheritance
+#include "User.hpp"		  // Include base User class for inheritance
+#include "FieldTable.hpp" // Describes the record fields for serialization and updates
 
 // The Admin class inherits from User and represents an administrator account.
 class Admin : public User
@@ -16,19 +17,29 @@ public:
 		  const std::string &contactNumber = "")
 		: User(username, password, fullName, email, contactNumber, Role::Admin) {}
 
+	// Descriptors of the scalar record fields (everything but id, role and createdAt)
+	static const FieldTable<Admin, 5> &fieldTable()
+	{
+		static constexpr FieldTable<Admin, 5> table({{
+			{"username", &Admin::username},			  // Admin username
+			{"password", &Admin::password},			  // Admin password (Consider encrypting before saving)
+			{"fullName", &Admin::fullName},			  // Full name of the admin
+			{"email", &Admin::email},				  // Email address
+			{"contactNumber", &Admin::contactNumber}, // Contact number
+		}});
+		static_assert(table.isPerfect(), "No perfect hash seed for the admin fields");
+		return table;
+	}
+
 	// Convert Admin object to JSON format for serialization
 	friend void to_json(json &j, const Admin &a)
 	{
 		j = json{
 			{"id", a.id},						 // Unique admin ID
 			{"role", a.getRoleToString(a.role)}, // Role as string (should be "Admin")
-			{"username", a.username},			 // Admin username
-			{"password", a.password},			 // Admin password (Consider encrypting before saving)
-			{"fullName", a.fullName},			 // Full name of the admin
-			{"email", a.email},					 // Email address
-			{"contactNumber", a.contactNumber},	 // Contact number
 			{"createdAt", a.getCreatedAt()}		 // Timestamp of account creation
 		};
+		fieldTable().toJson(j, a);
 	}
 
 	// Convert JSON object back to an Admin instance (deserialization)
@@ -37,53 +48,10 @@ public:
 		// Extract values from JSON and assign them to the Admin object
 		a.id = j.at("id").get<std::string>();
 		a.role = a.getRoleToEnum(j.at("role").get<std::string>());
-		a.username = j.at("username").get<std::string>();
-		a.password = j.at("password").get<std::string>();
-		a.fullName = j.at("fullName").get<std::string>();
-		a.email = j.at("email").get<std::string>();
-		a.contactNumber = j.at("contactNumber").get<std::string>();
+		fieldTable().fromJson(j, a);
 
 		// Deserialize the "createdAt" field (stored as a string) into a time_point object
-		std::string createdAtStr = j.at("createdAt").get<std::string>();
-		std::tm tm = {};
-		std::istringstream ss(createdAtStr);
-		ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S"); // Format should match stored timestamps
-
-		// If parsing fails, throw an error
-		if (ss.fail())
-		{
-			throw std::invalid_argument("Invalid date format for createdAt");
-		}
-
-		// Convert parsed std::tm to system_clock::time_point
-		std::time_t time = std::mktime(&tm);
-		a.createdAt = std::chrono::system_clock::from_time_t(time);
-	}
-
-	// Save Admin object as a JSON file in the database
-	void saveToFile() const
-	{
-		// Ensure the admin directory exists
-		std::filesystem::create_directories("db/admin");
-
-		// Generate file path using the Admin ID
-		std::string filePath = "db/admin/" + id + ".json";
-
-		// Serialize Admin object to JSON
-		json j = *this;
-
-		// Write JSON data to file
-		std::ofstream file(filePath);
-		if (file.is_open())
-		{
-			file << j.dump(4); // Pretty print JSON with 4-space indentation
-			file.close();
-		}
-		else
-		{
-			// Log an error if the file couldn't be opened
-			std::cerr << "Error: Could not open file to save admin data." << std::endl;
-		}
+		a.createdAt = parseTimestamp(j.at("createdAt").get<std::string>());
 	}
 };
 
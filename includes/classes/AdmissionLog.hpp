@@ -0,0 +1,175 @@
+#ifndef ADMISSION_LOG_H
+#define ADMISSION_LOG_H
+
+// Standard library headers
+#include <string>	 // Admission times are formatted as strings at the JSON and UI boundary
+#include <vector>	 // Holds the packed times and departments
+#include <map>		 // Returns the admission counts by department
+#include <array>	 // Groups the formatted dates by department while serializing
+#include <algorithm> // Provides the binary searches and the sort by time
+#include <numeric>	 // Provides std::iota for the sort permutation
+#include <chrono>	 // Converts between epoch seconds and time points
+#include <cstdint>	 // Provides the fixed-width time and department types
+#include <cstdio>	 // Provides std::snprintf for formatting times
+#include <ctime>	 // Provides localtime_r for converting times to local dates
+
+#include "json.hpp"		  // Admissions are serialized as department -> list of date strings
+#include "utils.hpp"	  // Provides parseTimestamp
+#include "admissions.hpp" // Departments and their names
+
+using json = nlohmann::json;
+
+// The AdmissionLog class holds a patient's admissions as one array ordered by admission time.
+// Each admission is its department (one byte) and its time in epoch seconds, kept in two parallel
+// vectors, so an admission costs 9 bytes instead of a heap string inside a per-department list.
+// Admissions made in the same second keep the order they were added in. Serialized, the log has
+// the same form as before: each department name maps to its "YYYY-MM-DD HH:MM:SS" dates, oldest first.
+class AdmissionLog
+{
+public:
+	using Time = std::int64_t; // Seconds since the epoch
+
+private:
+	std::vector<Time> times;				// Admission times, ascending
+	std::vector<std::uint8_t> departments;	// Department of each admission
+
+public:
+	// Epoch seconds of a "YYYY-MM-DD HH:MM:SS" local timestamp (throws std::invalid_argument when malformed)
+	static Time toTime(const std::string &dateTime)
+	{
+		return static_cast<Time>(std::chrono::system_clock::to_time_t(parseTimestamp(dateTime)));
+	}
+
+	// Local "YYYY-MM-DD HH:MM:SS" timestamp of epoch seconds (the form formatTimestamp writes, without a stream)
+	static std::string format(Time time)
+	{
+		std::time_t t = static_cast<std::time_t>(time);
+		std::tm tm{};
+		localtime_r(&t, &tm);
+
+		char buffer[64];
+		std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+					  tm.tm_hour, tm.tm_min, tm.tm_sec);
+		return buffer;
+	}
+
+	size_t size() const { return times.size(); }
+	bool empty() const { return times.empty(); }
+
+	// Time of the i-th oldest admission
+	Time time(size_t i) const { return times[i]; }
+
+	// Department of the i-th oldest admission
+	Admissions::Department department(size_t i) const { return static_cast<Admissions::Department>(departments[i]); }
+
+	// Formatted time of the i-th oldest admission
+	std::string dateTime(size_t i) const { return format(times[i]); }
+
+	// Record an admission in time order (normally at the end, as admissions are added as they happen)
+	void add(Admissions::Department dept, Time time)
+	{
+		size_t pos = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+		times.insert(times.begin() + pos, time);
+		departments.insert(departments.begin() + pos, static_cast<std::uint8_t>(dept));
+	}
+
+	// Remove one admission of a department at the given time; returns false if there is none
+	bool remove(Admissions::Department dept, Time time)
+	{
+		auto range = std::equal_range(times.begin(), times.end(), time);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			size_t pos = it - times.begin();
+			if (departments[pos] == static_cast<std::uint8_t>(dept))
+			{
+				times.erase(it);
+				departments.erase(departments.begin() + pos);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Add an admission without keeping the order; sort() must follow before the log is used
+	void append(Admissions::Department dept, Time time)
+	{
+		times.push_back(time);
+		departments.push_back(static_cast<std::uint8_t>(dept));
+	}
+
+	// Restore time order after append(), keeping the order of admissions made in the same second
+	void sort()
+	{
+		if (std::is_sorted(times.begin(), times.end()))
+			return;
+
+		std::vector<size_t> order(times.size());
+		std::iota(order.begin(), order.end(), size_t(0));
+		std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+						 { return times[a] < times[b]; });
+
+		std::vector<Time> sortedTimes(times.size());
+		std::vector<std::uint8_t> sortedDepartments(departments.size());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			sortedTimes[i] = times[order[i]];
+			sortedDepartments[i] = departments[order[i]];
+		}
+		times.swap(sortedTimes);
+		departments.swap(sortedDepartments);
+	}
+
+	// Number of admissions per department
+	std::map<Admissions::Department, int> counts() const
+	{
+		std::array<int, 256> byDepartment{};
+		for (std::uint8_t dept : departments)
+			++byDepartment[dept];
+
+		std::map<Admissions::Department, int> res;
+		for (size_t dept = 0; dept < byDepartment.size(); ++dept)
+		{
+			if (byDepartment[dept] > 0)
+				res[static_cast<Admissions::Department>(dept)] = byDepartment[dept];
+		}
+		return res;
+	}
+
+	// Bytes held by the log's arrays
+	size_t memoryBytes() const
+	{
+		return times.capacity() * sizeof(Time) + departments.capacity() * sizeof(std::uint8_t);
+	}
+
+	// Serialize as department name -> dates, oldest first
+	json toJson() const
+	{
+		std::array<json, 256> byDepartment;
+		for (size_t i = 0; i < times.size(); ++i)
+			byDepartment[departments[i]].push_back(format(times[i]));
+
+		json j = json::object();
+		for (size_t dept = 0; dept < byDepartment.size(); ++dept)
+		{
+			if (!byDepartment[dept].is_null())
+				j[Admissions::departmentToString(static_cast<Admissions::Department>(dept))] = std::move(byDepartment[dept]);
+		}
+		return j;
+	}
+
+	// Read the serialized form written by toJson()
+	static AdmissionLog fromJson(const json &j)
+	{
+		AdmissionLog log;
+		for (const auto &[deptStr, dates] : j.items())
+		{
+			Admissions::Department dept = Admissions::stringToDepartment(deptStr);
+			for (const auto &date : dates)
+				log.append(dept, toTime(date.get<std::string>()));
+		}
+		log.sort();
+		return log;
+	}
+};
+
+#endif // ADMISSION_LOG_H
@@ -0,0 +1,156 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+// Standard library headers
+#include <string>	  // Provides std::string for file paths
+#include <iostream>	  // Provides std::cerr for error reporting
+#include <fstream>	  // Reads the snapshot and marker files and streams the snapshot out
+#include <filesystem> // Supports removing the marker and staging files
+#include <cstdio>	  // Provides std::rename for atomic replacement
+#include <vector>	  // Holds the read buffer of the snapshot stream
+
+#include "json.hpp" // Snapshots are stored as a single compact JSON document (written record by record)
+#include "FileSync.hpp" // Writes and syncs the staged file and its directory
+
+using json = nlohmann::json;
+
+// The Checkpoint struct reads and writes the consolidated snapshot of every record.
+// db/snapshot.json holds all admins and patients; db/snapshot.marker is written after it and
+// tells startup that the snapshot is complete and still matches the store.
+struct Checkpoint
+{
+	static constexpr const char *snapshotPath = "db/snapshot.json";
+	static constexpr const char *markerPath = "db/snapshot.marker";
+
+	// Write content to path through a synced temporary file and an atomic rename, then sync the
+	// directory so the renamed file survives a crash
+	static bool writeAtomically(const std::string &path, const std::string &content)
+	{
+		std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+		std::string tmpPath = path + ".tmp";
+		if (!FileSync::writeFile(tmpPath, content, true) || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+		{
+			std::filesystem::remove(tmpPath);
+			return false;
+		}
+		return FileSync::syncParent(path);
+	}
+
+	// Writes the snapshot file a piece at a time into a staged file, so the snapshot never has to be
+	// held in memory whole. commit() syncs it and renames it into place; the marker must be written
+	// afterwards to validate it. A writer destroyed without a successful commit() removes the staged file.
+	class SnapshotWriter
+	{
+		std::string tmpPath = std::string(snapshotPath) + ".tmp";
+		std::ofstream file;
+		bool failed = false;
+		bool committed = false;
+
+		void fail()
+		{
+			if (!failed)
+				std::cerr << "Error: Could not write checkpoint " << snapshotPath << std::endl;
+			failed = true;
+		}
+
+	public:
+		SnapshotWriter()
+		{
+			std::filesystem::create_directories(std::filesystem::path(snapshotPath).parent_path());
+			file.open(tmpPath, std::ios::binary | std::ios::trunc);
+		}
+
+		~SnapshotWriter()
+		{
+			if (committed)
+				return;
+			file.close();
+			std::error_code ec;
+			std::filesystem::remove(tmpPath, ec);
+		}
+
+		SnapshotWriter(const SnapshotWriter &) = delete;
+		SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+		// Append bytes to the staged snapshot; returns false once a write has failed
+		bool write(const std::string &bytes)
+		{
+			if (!failed && !file.write(bytes.data(), static_cast<std::streamsize>(bytes.size())))
+				fail();
+			return !failed;
+		}
+
+		// Sync the staged snapshot and rename it into place
+		bool commit()
+		{
+			file.close();
+			if (failed || file.fail() || !FileSync::syncFile(tmpPath) || std::rename(tmpPath.c_str(), snapshotPath) != 0 ||
+				!FileSync::syncParent(snapshotPath))
+			{
+				fail();
+				return false;
+			}
+			committed = true;
+			return true;
+		}
+	};
+
+	// Write the marker that declares the snapshot complete and current
+	static bool writeMarker(const json &marker)
+	{
+		if (!writeAtomically(markerPath, marker.dump()))
+		{
+			std::cerr << "Error: Could not write checkpoint marker " << markerPath << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	// Storage mode named by the marker, or an empty string if there is no readable marker
+	static std::string markerStorage()
+	{
+		std::ifstream file(markerPath);
+		if (!file.is_open())
+			return "";
+		json marker = json::parse(file, nullptr, false);
+		if (!marker.is_object())
+			return "";
+		return marker.value("storage", "");
+	}
+
+	// Check whether a complete, valid checkpoint is present
+	static bool hasMarker()
+	{
+		return std::filesystem::exists(markerPath) && std::filesystem::exists(snapshotPath);
+	}
+
+	// Check whether a snapshot file is present (it is always complete thanks to the atomic rename)
+	static bool hasSnapshot()
+	{
+		return std::filesystem::exists(snapshotPath);
+	}
+
+	// Mark the current snapshot as stale
+	static void invalidate()
+	{
+		std::error_code ec;
+		std::filesystem::remove(markerPath, ec);
+	}
+
+	// Stream the snapshot through a SAX handler (see SnapshotDecoder) without reading it into memory
+	// first; returns false if it is missing, not valid JSON or abandoned by the handler
+	template <typename Handler>
+	static bool read(Handler &handler)
+	{
+		std::vector<char> buffer(1 << 20);
+		std::ifstream file;
+		file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		file.open(snapshotPath, std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		return json::sax_parse(file, &handler);
+	}
+};
+
+#endif // CHECKPOINT_H
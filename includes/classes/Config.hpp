@@ -0,0 +1,113 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <string>  // Provides std::string for reading option values
+#include <cstdlib> // Provides std::getenv for reading environment variables
+
+// Enum class defining how UserManager persists records
+enum class StorageMode
+{
+	Files, // One JSON file per record under db/<role>/ (default)
+	Log	   // Append-only change log at db/records.log
+};
+
+// Enum class defining the on-disk encoding of per-record files
+enum class RecordFormat
+{
+	Json,		// Text JSON (<id>.json, default)
+	Cbor,		// Binary CBOR (<id>.cbor)
+	MessagePack // Binary MessagePack (<id>.msgpack)
+};
+
+// Enum class defining how record files are spread over directories
+enum class RecordLayout
+{
+	Flat,	// Every record of a role in db/<role>/ (default)
+	Sharded // db/<role>/<first two ID characters>/, so no directory grows past a few thousand entries
+};
+
+// Enum class defining when record file writes are synced to disk
+enum class Durability
+{
+	Sync,  // Every write is synced before it returns
+	Group, // Writes are synced together every groupCommitMs (default)
+	None   // Writes are never synced explicitly
+};
+
+// The Config struct holds runtime options read once from HMS_* environment variables.
+struct Config
+{
+	StorageMode storageMode = StorageMode::Files; // HMS_STORAGE=files|log
+	int groupCommitMs = 50;						  // HMS_GROUP_COMMIT_MS: how long appended log records and grouped record writes may wait before being synced
+	int checkpointSeconds = 0;					  // HMS_CHECKPOINT_SECONDS: interval between background checkpoints (0 disables them; 60 by default in log mode and lazy files mode)
+	int loaderThreads = 0;						  // HMS_LOADER_THREADS: threads parsing record files at startup (0 = one per core)
+	RecordFormat recordFormat = RecordFormat::Json; // HMS_FORMAT=json|cbor|msgpack: format used when writing records
+	bool prettyJson = true;							// HMS_PRETTY_JSON=0: write JSON records without indentation
+	RecordLayout recordLayout = RecordLayout::Flat;	// HMS_LAYOUT=flat|sharded: directory layout of record files
+	Durability durability = Durability::Group;		// HMS_DURABILITY=sync|group|none: when record file writes are synced
+	bool lazyLoad = false;						  // HMS_LAZY_LOAD=1: load patient summaries at startup, full records on demand (files mode)
+	int cacheUsers = 0;							  // HMS_CACHE_USERS: most full patient records kept in memory in lazy mode (0 = no limit)
+	int cacheMb = 0;							  // HMS_CACHE_MB: memory budget in MiB for full patient records in lazy mode (0 = no limit)
+	int writeQueue = 256;						  // HMS_WRITE_QUEUE: most record saves waiting for the background writer (0 = write on the calling thread)
+	bool asyncDelete = false;					  // HMS_ASYNC_DELETE=1: remove deleted record files on a background thread (files mode)
+
+	// Singleton Implementation - Ensures only one instance of Config exists
+	static Config &getInstance()
+	{
+		static Config instance;
+		return instance;
+	}
+
+	// Delete copy constructor and assignment operator to prevent accidental copies
+	Config(const Config &) = delete;
+	Config &operator=(const Config &) = delete;
+
+private:
+	// Private constructor loads the options from the environment
+	Config()
+	{
+		std::string storage = getOption("HMS_STORAGE", "files");
+		storageMode = storage == "log" ? StorageMode::Log : StorageMode::Files;
+		groupCommitMs = getIntOption("HMS_GROUP_COMMIT_MS", groupCommitMs);
+		loaderThreads = getIntOption("HMS_LOADER_THREADS", loaderThreads);
+		lazyLoad = getOption("HMS_LAZY_LOAD", "0") == "1";
+		// A lazy start only skips decoding every record file when it finds a summary checkpoint
+		checkpointSeconds = getIntOption("HMS_CHECKPOINT_SECONDS", storageMode == StorageMode::Log || lazyLoad ? 60 : checkpointSeconds);
+		cacheUsers = getIntOption("HMS_CACHE_USERS", cacheUsers);
+		cacheMb = getIntOption("HMS_CACHE_MB", cacheMb);
+		writeQueue = getIntOption("HMS_WRITE_QUEUE", writeQueue);
+		asyncDelete = getOption("HMS_ASYNC_DELETE", "0") == "1";
+		std::string format = getOption("HMS_FORMAT", "json");
+		recordFormat = format == "cbor" ? RecordFormat::Cbor : format == "msgpack" ? RecordFormat::MessagePack : RecordFormat::Json;
+		prettyJson = getOption("HMS_PRETTY_JSON", "1") != "0";
+		std::string durabilityOption = getOption("HMS_DURABILITY", "group");
+		durability = durabilityOption == "sync" ? Durability::Sync : durabilityOption == "none" ? Durability::None : Durability::Group;
+		recordLayout = getOption("HMS_LAYOUT", "flat") == "sharded" ? RecordLayout::Sharded : RecordLayout::Flat;
+	}
+
+	// Read a string option, falling back to the default when unset
+	static std::string getOption(const char *name, const std::string &fallback)
+	{
+		const char *value = std::getenv(name);
+		return value ? std::string(value) : fallback;
+	}
+
+	// Read a non-negative integer option, falling back to the default when unset or invalid
+	static int getIntOption(const char *name, int fallback)
+	{
+		const char *value = std::getenv(name);
+		if (!value)
+			return fallback;
+		try
+		{
+			int parsed = std::stoi(value);
+			return parsed >= 0 ? parsed : fallback;
+		}
+		catch (...)
+		{
+			return fallback;
+		}
+	}
+};
+
+#endif // CONFIG_H
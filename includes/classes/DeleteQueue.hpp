@@ -0,0 +1,195 @@
+#ifndef DELETE_QUEUE_H
+#define DELETE_QUEUE_H
+
+// Standard library headers
+#include <string>			  // Provides std::string for roles, IDs and the journal path
+#include <vector>			  // Holds the queued removals
+#include <set>				  // Collects the record directories to sync after a batch
+#include <utility>			  // Provides std::pair for (role, id) removals
+#include <iostream>			  // Provides std::cerr for error reporting
+#include <fstream>			  // Reads the journal back at startup
+#include <filesystem>		  // Supports creating the journal directory
+#include <thread>			  // Runs the background removal thread
+#include <mutex>			  // Guards the queue shared with the removal thread
+#include <condition_variable> // Wakes the removal thread when work arrives or the queue drains
+
+// POSIX headers for appending to, syncing and truncating the journal
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "json.hpp"		  // Tombstones are stored as compact single-line JSON
+#include "RecordFile.hpp" // Removes record files
+#include "FileSync.hpp"	  // Appends to the journal and syncs the record directories
+
+using json = nlohmann::json;
+
+// The DeleteQueue class removes record files on a background thread so that a delete returns at once.
+// Every removal is first appended to a tombstone journal; the thread removes the files in batches,
+// syncs each touched record directory once per batch and empties the journal once nothing is left.
+// Tombstones still in the journal after a crash are carried out by replay() at the next start.
+class DeleteQueue
+{
+public:
+	using Removal = std::pair<std::string, std::string>; // (role, id)
+
+private:
+	std::string path; // Path of the tombstone journal
+	int fd = -1;	  // Journal descriptor opened in append mode
+	std::vector<Removal> queued;
+	bool busy = false; // A batch taken from queued is being removed
+	bool stopping = false;
+	std::mutex queueMutex; // Guards queued, busy and stopping
+	std::condition_variable workCv;
+	std::condition_variable idleCv;
+	std::thread worker;
+
+	// Append tombstones to the journal and sync it, so a delete that returned survives a crash
+	void record(const std::vector<Removal> &removals)
+	{
+		std::string lines;
+		for (const auto &[role, id] : removals)
+		{
+			lines += json{{"role", role}, {"id", id}}.dump();
+			lines += '\n';
+		}
+
+		if (!FileSync::writeAll(fd, lines.data(), lines.size()))
+		{
+			std::cerr << "Error: Could not append to tombstone journal " << path << std::endl;
+			return;
+		}
+		if (::fdatasync(fd) != 0)
+			std::cerr << "Error: Could not sync tombstone journal " << path << std::endl;
+	}
+
+	// Background loop: remove whatever is queued, then empty the journal once the queue is idle
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(queueMutex);
+		while (true)
+		{
+			workCv.wait(lock, [this]
+						{ return stopping || !queued.empty(); });
+			if (queued.empty())
+				break; // Stopping with nothing left to remove
+
+			std::vector<Removal> batch;
+			batch.swap(queued);
+			busy = true;
+			lock.unlock();
+			removeAll(batch);
+			lock.lock();
+			busy = false;
+
+			if (queued.empty())
+			{
+				if (::ftruncate(fd, 0) != 0) // Every tombstone in the journal has been carried out
+					std::cerr << "Error: Could not empty tombstone journal " << path << std::endl;
+				idleCv.notify_all();
+			}
+		}
+	}
+
+public:
+	DeleteQueue() = default;
+	~DeleteQueue() { close(); }
+	DeleteQueue(const DeleteQueue &) = delete;
+	DeleteQueue &operator=(const DeleteQueue &) = delete;
+
+	// Remove record files, then sync each directory they were in once
+	static void removeAll(const std::vector<Removal> &removals)
+	{
+		std::set<std::string> directories;
+		for (const auto &[role, id] : removals)
+		{
+			if (RecordFile::remove(role, id))
+				directories.insert(RecordFile::directory(role, id));
+		}
+		for (const std::string &dir : directories)
+			FileSync::syncDirectory(dir);
+	}
+
+	// Carry out the tombstones left in a journal by an earlier run, then delete the journal
+	static void replay(const std::string &journalPath)
+	{
+		std::ifstream file(journalPath);
+		if (!file.is_open())
+			return;
+
+		std::vector<Removal> removals;
+		std::string line;
+		while (std::getline(file, line))
+		{
+			json tombstone = json::parse(line, nullptr, false);
+			if (!tombstone.is_discarded() && tombstone.is_object()) // A torn last line is skipped
+				removals.emplace_back(tombstone.value("role", ""), tombstone.value("id", ""));
+		}
+		file.close();
+
+		removeAll(removals);
+		std::error_code ec;
+		std::filesystem::remove(journalPath, ec);
+	}
+
+	// Open (or create) the journal and start the removal thread
+	bool open(const std::string &journalPath)
+	{
+		path = journalPath;
+		std::filesystem::path parent = std::filesystem::path(path).parent_path();
+		if (!parent.empty())
+			std::filesystem::create_directories(parent);
+
+		fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+		if (fd < 0)
+		{
+			std::cerr << "Error: Could not open tombstone journal " << path << std::endl;
+			return false;
+		}
+		stopping = false;
+		worker = std::thread(&DeleteQueue::run, this);
+		return true;
+	}
+
+	// Check whether removals are handed to the background thread
+	bool isOpen() const { return fd >= 0; }
+
+	// Record tombstones for the given records (durably, before returning) and queue their files for removal
+	void push(const std::vector<Removal> &removals)
+	{
+		if (removals.empty())
+			return;
+		std::lock_guard<std::mutex> lock(queueMutex);
+		record(removals);
+		queued.insert(queued.end(), removals.begin(), removals.end());
+		workCv.notify_one();
+	}
+
+	// Wait until every queued removal has been carried out
+	void drain()
+	{
+		std::unique_lock<std::mutex> lock(queueMutex);
+		idleCv.wait(lock, [this]
+					{ return queued.empty() && !busy; });
+	}
+
+	// Carry out the remaining removals, stop the thread and close the journal
+	void close()
+	{
+		if (worker.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(queueMutex);
+				stopping = true;
+			}
+			workCv.notify_one();
+			worker.join();
+		}
+		if (fd >= 0)
+		{
+			::close(fd);
+			fd = -1;
+		}
+	}
+};
+
+#endif // DELETE_QUEUE_H
@@ -17,6 +17,7 @@ private:
     Screen screen;                                         // Tracks the current screen state
     UserManager &userManager = UserManager::getInstance(); // Singleton reference to user management system
     bool isRunning = false;                                // Flag to control the event loop
+    static inline std::atomic<bool> exitRequested{false};  // Set by the signal thread, acted on by the UI thread
 
     // Private constructor to enforce singleton pattern
     EventManager() : screen(Screen::Login) {}
@@ -124,6 +125,19 @@ public:
         return instance;
     }
 
+    // Ask the UI thread to exit (safe to call from any thread, e.g. on SIGINT); readKey() sees the
+    // request and takes the same path as the Esc key, so flush() and exit() run on the UI thread
+    static void requestExit()
+    {
+        exitRequested = true;
+    }
+
+    // Check whether an exit was requested from another thread
+    static bool isExitRequested()
+    {
+        return exitRequested;
+    }
+
     // Switch the active screen and trigger a re-render
     void switchScreen(Screen newScreen)
     {
@@ -154,7 +168,7 @@ public:
         // Main event loop to render UI updates
         try
         {
-            while (isRunning)
+            while (isRunning && !exitRequested)
             {
                 renderLayout();
                 std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Reduce CPU usage
@@ -168,13 +182,19 @@ public:
         exit();
     }
 
-    // Safely stop the event loop and clean up terminal state
+    // Safely stop the event loop and clean up terminal state (UI thread only)
     void exit()
     {
         isRunning = false;
+        bool committed = userManager.flush(); // Commit buffered record changes before leaving
         clear();
         refresh();
         endwin(); // Restore terminal settings
+        if (!committed)
+        {
+            std::cerr << "Error: Some changes could not be written to the record log." << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
         std::exit(0);
     }
 };
@@ -0,0 +1,152 @@
+#ifndef FIELD_TABLE_H
+#define FIELD_TABLE_H
+
+// Standard library headers
+#include <string>	   // Provides std::string for text fields and parsed values
+#include <string_view> // Field names are compile-time string views
+#include <array>	   // Holds the descriptors and the hash slots
+#include <cstdint>	   // Provides the 32-bit hash and seed
+
+#include "json.hpp" // Fields are serialized through nlohmann::json
+
+using json = nlohmann::json;
+
+// The FieldDescriptor struct describes one scalar field of a record: the key it is stored under,
+// the member holding it and so how its value is serialized, deserialized and parsed from form input.
+template <typename T>
+struct FieldDescriptor
+{
+	std::string_view name;				// Record key, also the field name used by updates and forms
+	std::string T::*text = nullptr;		// Member of a text field
+	int T::*integer = nullptr;			// Member of an integer field
+	double T::*real = nullptr;			// Member of a floating-point field
+	bool editable = true;				// Shown on the update form (derived fields are recomputed instead)
+
+	constexpr FieldDescriptor(std::string_view name, std::string T::*member, bool editable = true)
+		: name(name), text(member), editable(editable) {}
+	constexpr FieldDescriptor(std::string_view name, int T::*member, bool editable = true)
+		: name(name), integer(member), editable(editable) {}
+	constexpr FieldDescriptor(std::string_view name, double T::*member, bool editable = true)
+		: name(name), real(member), editable(editable) {}
+
+	// Store the field of obj in j
+	void toJson(json &j, const T &obj) const
+	{
+		json &value = j[std::string(name)];
+		if (text)
+			value = obj.*text;
+		else if (integer)
+			value = obj.*integer;
+		else
+			value = obj.*real;
+	}
+
+	// Read the field of obj from j; throws if it is missing or of the wrong type
+	void fromJson(const json &j, T &obj) const
+	{
+		const json &value = j.at(std::string(name));
+		if (text)
+			obj.*text = value.get<std::string>();
+		else if (integer)
+			obj.*integer = value.get<int>();
+		else
+			obj.*real = value.get<double>();
+	}
+
+	// Set the field of obj from text input; throws std::invalid_argument if a number does not parse
+	void parse(const std::string &value, T &obj) const
+	{
+		if (text)
+			obj.*text = value;
+		else if (integer)
+			obj.*integer = std::stoi(value);
+		else
+			obj.*real = std::stod(value);
+	}
+
+	// Field of obj as text, as shown on a form
+	std::string format(const T &obj) const
+	{
+		if (text)
+			return obj.*text;
+		if (integer)
+			return std::to_string(obj.*integer);
+		return std::to_string(obj.*real);
+	}
+};
+
+// The FieldTable class holds the field descriptors of a record type and finds a field by name through a
+// perfect hash built at compile time: the seed is chosen so that every name lands in its own slot, and a
+// lookup costs one hash of the name and one comparison, with no allocation.
+template <typename T, size_t N>
+class FieldTable
+{
+private:
+	static constexpr size_t slotCount = 64; // Power of two; at least twice N keeps the seed search short
+	static_assert(N * 2 <= slotCount, "Too many fields for the perfect hash");
+
+	std::array<FieldDescriptor<T>, N> fields;
+	std::array<int, slotCount> slots{}; // Slot -> index into fields, -1 when empty
+	std::uint32_t seed = 0;
+	bool perfect = false;
+
+	// Seeded FNV-1a hash of a name, folded onto the slots
+	static constexpr size_t slot(std::string_view name, std::uint32_t seed)
+	{
+		std::uint32_t hash = 2166136261u ^ seed;
+		for (char c : name)
+		{
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 16777619u;
+		}
+		return (hash ^ (hash >> 15)) & (slotCount - 1);
+	}
+
+public:
+	// Search for the first seed that gives every field its own slot
+	constexpr FieldTable(const std::array<FieldDescriptor<T>, N> &descriptors) : fields(descriptors)
+	{
+		for (std::uint32_t candidate = 0; candidate < 4096 && !perfect; ++candidate)
+		{
+			for (int &index : slots)
+				index = -1;
+			perfect = true;
+			for (size_t i = 0; i < N && perfect; ++i)
+			{
+				int &index = slots[slot(fields[i].name, candidate)];
+				perfect = index < 0;
+				index = static_cast<int>(i);
+			}
+			seed = candidate;
+		}
+	}
+
+	// Whether a collision-free seed was found (checked with static_assert where a table is defined)
+	constexpr bool isPerfect() const { return perfect; }
+
+	// Descriptor of the field with the given name, or nullptr if the record has no such field
+	constexpr const FieldDescriptor<T> *find(std::string_view name) const
+	{
+		int index = slots[slot(name, seed)];
+		return index >= 0 && fields[index].name == name ? &fields[index] : nullptr;
+	}
+
+	constexpr const FieldDescriptor<T> *begin() const { return fields.data(); }
+	constexpr const FieldDescriptor<T> *end() const { return fields.data() + N; }
+
+	// Store every field of obj in j
+	void toJson(json &j, const T &obj) const
+	{
+		for (const auto &field : fields)
+			field.toJson(j, obj);
+	}
+
+	// Read every field of obj from j; throws if one is missing or of the wrong type
+	void fromJson(const json &j, T &obj) const
+	{
+		for (const auto &field : fields)
+			field.fromJson(j, obj);
+	}
+};
+
+#endif // FIELD_TABLE_H
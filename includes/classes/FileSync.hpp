@@ -0,0 +1,76 @@
+#ifndef FILE_SYNC_H
+#define FILE_SYNC_H
+
+// Standard library headers
+#include <string>	  // Provides std::string for file paths
+#include <filesystem> // Finds the directory holding a file
+#include <cstddef>	  // Provides size_t for byte counts
+#include <cerrno>	  // Provides errno for retrying interrupted writes
+
+// POSIX headers for writing and syncing files and directories
+#include <fcntl.h>
+#include <unistd.h>
+
+// The FileSync struct holds the low-level write and sync steps shared by every file the store writes:
+// record files, the change log, the tombstone journal and the checkpoint. Each reports failure by
+// returning false; the caller decides whether that is an error worth printing.
+struct FileSync
+{
+	// Write size bytes to fd, continuing after partial and interrupted writes; returns false on an error
+	static bool writeAll(int fd, const char *data, size_t size)
+	{
+		while (size > 0)
+		{
+			ssize_t written = ::write(fd, data, size);
+			if (written < 0 && errno == EINTR)
+				continue;
+			if (written <= 0)
+				return false;
+			data += written;
+			size -= static_cast<size_t>(written);
+		}
+		return true;
+	}
+
+	// Create or truncate the file at path and write bytes to it, syncing it before it is closed if sync is set
+	static bool writeFile(const std::string &path, const std::string &bytes, bool sync)
+	{
+		int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0)
+			return false;
+		bool ok = writeAll(fd, bytes.data(), bytes.size()) && (!sync || ::fsync(fd) == 0);
+		::close(fd);
+		return ok;
+	}
+
+	// Sync a file that is already written and closed
+	static bool syncFile(const std::string &path)
+	{
+		return syncOpened(path, O_RDONLY);
+	}
+
+	// Sync a directory, so that files just renamed into it or removed from it stay that way after a crash
+	static bool syncDirectory(const std::string &dir)
+	{
+		return syncOpened(dir.empty() ? "." : dir, O_RDONLY | O_DIRECTORY);
+	}
+
+	// Sync the directory holding path (see syncDirectory)
+	static bool syncParent(const std::string &path)
+	{
+		return syncDirectory(std::filesystem::path(path).parent_path().string());
+	}
+
+private:
+	static bool syncOpened(const std::string &path, int flags)
+	{
+		int fd = ::open(path.c_str(), flags);
+		if (fd < 0)
+			return false;
+		bool ok = ::fsync(fd) == 0;
+		::close(fd);
+		return ok;
+	}
+};
+
+#endif // FILE_SYNC_H
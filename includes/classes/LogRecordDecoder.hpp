@@ -0,0 +1,277 @@
+#ifndef LOG_RECORD_DECODER_H
+#define LOG_RECORD_DECODER_H
+
+// Standard library headers
+#include <string>	  // Provides std::string for the record's fields
+#include <vector>	  // Holds the field changes of an update-fields record
+#include <utility>	  // Provides std::pair for a field name and its new value
+#include <stdexcept>  // Provides std::invalid_argument for a create record without data
+#include <filesystem> // Names the log file in error messages
+#include <cstdint>	  // Provides the record's sequence number
+#include <memory>	  // Holds the decoded user in a std::shared_ptr
+
+#include "json.hpp"			 // SAX interface of the JSON parser
+#include "RecordDecoder.hpp" // Decodes the user held by a create record
+#include "Admin.hpp"		 // Admin a create record can hold
+#include "Patient.hpp"		 // Patient a create record can hold
+
+using json = nlohmann::json;
+
+// The LogRecordDecoder class reads one line of the change log as a stream of SAX events, without
+// building a json document. read() keeps the top-level fields (op, id, seq and the arguments of updates
+// and admission changes) and hands the user object of a create record to a RecordDecoder, which fills
+// the user as the values are read. A create record names its role in op ("create-admin" or
+// "create-patient") and holds the user under "user"; records are written with their keys sorted, so
+// op is always read first and the user is decoded straight into the Admin or Patient it names.
+// Create records written before that held the user under "data", which sorts before the separate role
+// key: their data is decoded into a Patient, since an admin's fields are a subset of a patient's, and
+// moved into an Admin once the role turns out to be "admin".
+class LogRecordDecoder
+{
+public:
+	std::string op;											 // Change the record describes ("create" for every create record)
+	std::string role;										 // Role of the user a create record holds
+	std::string id;											 // User the change applies to
+	std::uint64_t seq = 0;									 // Sequence number of the record
+	std::string field;										 // Field changed by an update
+	std::string value;										 // New value of that field
+	std::vector<std::pair<std::string, std::string>> fields; // Fields and values changed by an update-fields
+	std::string department;									 // Department of an admission change
+	std::string dateTime;									 // Date of an admission change
+	std::shared_ptr<User> user;								 // Admin or Patient held by a create record
+
+private:
+	// Top-level keys of a change record
+	enum Section
+	{
+		Other,
+		Data,
+		Op,
+		Role,
+		Id,
+		Seq,
+		Field,
+		Value,
+		Fields,
+		Department,
+		DateTime
+	};
+
+	RecordDecoder *record = nullptr; // Decoder of the user object
+	int depth = 0;					 // Nesting outside the user being decoded (1 = record object)
+	Section section = Other;		 // Top-level key whose value is being read
+	std::string fieldName;			 // Field whose new value comes next in an update-fields record
+	bool inRecord = false;			 // Events belong to the user object
+	bool decoded = false;			 // The user object was decoded completely
+
+	LogRecordDecoder() = default;
+
+	// Store a top-level string in the member its key names
+	void setString(std::string &text)
+	{
+		switch (section)
+		{
+		case Op:
+			op = std::move(text);
+			break;
+		case Role:
+			role = std::move(text);
+			break;
+		case Id:
+			id = std::move(text);
+			break;
+		case Field:
+			field = std::move(text);
+			break;
+		case Value:
+			value = std::move(text);
+			break;
+		case Department:
+			department = std::move(text);
+			break;
+		case DateTime:
+			dateTime = std::move(text);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Store a top-level number (only seq is one)
+	bool setNumber(std::uint64_t number)
+	{
+		if (depth == 1 && section == Seq)
+			seq = number;
+		return true;
+	}
+
+	// Run the parser over one log line
+	void run(const std::string &line)
+	{
+		json::sax_parse(line, this);
+	}
+
+	// A create record must hold its user
+	void checkDecoded(const std::filesystem::path &logPath) const
+	{
+		if (!decoded)
+			throw std::invalid_argument("Create record without data in " + logPath.string());
+	}
+
+public:
+	// Read one log line. A create record comes back with op "create", its role and its Admin or Patient
+	// decoded, whichever form it was written in; an earlier create record of an unknown role comes back
+	// without a user.
+	static LogRecordDecoder read(const std::string &line, const std::filesystem::path &logPath)
+	{
+		RecordDecoder data;
+		data.source = &logPath;
+		LogRecordDecoder decoder;
+		decoder.record = &data;
+		decoder.run(line);
+		decoder.record = nullptr;
+		if (decoder.op == "create-admin" || decoder.op == "create-patient")
+		{
+			decoder.role = decoder.op.substr(decoder.op.find('-') + 1);
+			decoder.op = "create";
+		}
+		else if (decoder.op != "create" || (decoder.role != "admin" && decoder.role != "patient"))
+		{
+			decoder.user = nullptr;
+			return decoder;
+		}
+		decoder.checkDecoded(logPath);
+
+		if (decoder.role == "admin" && std::dynamic_pointer_cast<Patient>(decoder.user))
+		{
+			auto admin = std::make_shared<Admin>();
+			data.finishAs(*admin);
+			decoder.user = admin;
+			return decoder;
+		}
+		data.finish();
+		return decoder;
+	}
+
+	// SAX events (see nlohmann::json_sax); events inside the data object go to its decoder
+
+	bool null() { return inRecord ? record->null() : true; }
+	bool boolean(bool flag) { return inRecord ? record->boolean(flag) : true; }
+	bool binary(json::binary_t &bytes) { return inRecord ? record->binary(bytes) : true; }
+	bool number_integer(json::number_integer_t number) { return inRecord ? record->number_integer(number) : setNumber(static_cast<std::uint64_t>(number)); }
+	bool number_unsigned(json::number_unsigned_t number) { return inRecord ? record->number_unsigned(number) : setNumber(number); }
+	bool number_float(json::number_float_t number, const json::string_t &text) { return inRecord ? record->number_float(number, text) : true; }
+
+	bool string(json::string_t &text)
+	{
+		if (inRecord)
+			return record->string(text);
+		if (depth == 1)
+			setString(text);
+		else if (depth == 2 && section == Fields)
+			fields.emplace_back(std::move(fieldName), std::move(text));
+		return true;
+	}
+
+	bool key(json::string_t &name)
+	{
+		if (inRecord)
+			return record->key(name);
+		if (depth == 2 && section == Fields)
+		{
+			fieldName = std::move(name);
+		}
+		else if (depth == 1)
+		{
+			if (name == "user" || name == "data")
+				section = Data;
+			else if (name == "op")
+				section = Op;
+			else if (name == "role")
+				section = Role;
+			else if (name == "id")
+				section = Id;
+			else if (name == "seq")
+				section = Seq;
+			else if (name == "field")
+				section = Field;
+			else if (name == "value")
+				section = Value;
+			else if (name == "fields")
+				section = Fields;
+			else if (name == "department")
+				section = Department;
+			else if (name == "dateTime")
+				section = DateTime;
+			else
+				section = Other;
+		}
+		return true;
+	}
+
+	bool start_object(std::size_t size)
+	{
+		if (!inRecord && depth == 1 && section == Data && !decoded)
+		{
+			inRecord = true;
+			if (op == "create-admin")
+			{
+				auto admin = std::make_shared<Admin>();
+				record->start(*admin);
+				user = admin;
+			}
+			else
+			{
+				auto patient = std::make_shared<Patient>();
+				record->start(*patient);
+				user = patient;
+			}
+		}
+		if (inRecord)
+			return record->start_object(size);
+		++depth;
+		return true;
+	}
+
+	bool end_object()
+	{
+		if (!inRecord)
+		{
+			--depth;
+			return true;
+		}
+
+		record->end_object();
+		if (record->depth == 0)
+		{
+			inRecord = false; // Checked once the whole line is read
+			decoded = true;
+		}
+		return true;
+	}
+
+	bool start_array(std::size_t size)
+	{
+		if (inRecord)
+			return record->start_array(size);
+		++depth;
+		return true;
+	}
+
+	bool end_array()
+	{
+		if (inRecord)
+			return record->end_array();
+		--depth;
+		return true;
+	}
+
+	// A line that is not valid JSON is corrupt; the parser's exception is thrown as its concrete type
+	template <typename Exception>
+	bool parse_error(std::size_t, const std::string &, const Exception &ex)
+	{
+		throw ex;
+	}
+};
+
+#endif // LOG_RECORD_DECODER_H
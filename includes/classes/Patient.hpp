@@ -4,10 +4,11 @@
 // Includes standard libraries and project-specific dependencies
 
 #include <unordered_map>  // Used to store patient attributes efficiently
-#include <map>            // Used for the admissions log (department -> list of dates)
 #include "utils.hpp"      // Provides utility functions such as timestamp formatting
 #include "User.hpp"       // Base class for all users (Patient inherits from User)
 #include "admissions.hpp" // Handles department-based admissions and their string conversions
+#include "FieldTable.hpp" // Describes the record fields for serialization and updates
+#include "AdmissionLog.hpp" // Packed, time-ordered admissions log
 
 class Patient : public User
 {
@@ -31,8 +32,8 @@ public:
     std::string height; // Patient's height in cm or inches
     std::string weight; // Patient's weight in kg or lbs
 
-    // Admissions log (Department -> List of admission dates)
-    std::map<Admissions::Department, std::vector<std::string>> admissions;
+    // Admissions log (department and time of every admission, oldest first)
+    AdmissionLog admissions;
 
     // Default constructor initializes age and BMI to default values
     Patient() : User(), age(0), bmi(0) {}
@@ -58,34 +59,66 @@ public:
     ~Patient() = default;
 
     /**
-     * Adds an admission record for a specific department.
-     * Records the current timestamp and saves the updated information.
+     * Adds an admission record for a specific department at the current time.
+     * Returns the recorded timestamp; persisting the change is left to UserManager.
      */
-    void addAdmission(Admissions::Department dept)
+    std::string addAdmission(Admissions::Department dept)
     {
-        std::string dateTime = formatTimestamp(std::chrono::system_clock::now());
-        admissions[dept].push_back(dateTime);
-        saveToFile();
+        AdmissionLog::Time now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        admissions.add(dept, now);
+        return AdmissionLog::format(now);
+    }
+
+    /**
+     * Adds an admission record with a known timestamp (used when replaying stored changes).
+     */
+    void addAdmission(Admissions::Department dept, const std::string &dateTime)
+    {
+        admissions.add(dept, AdmissionLog::toTime(dateTime));
     }
 
     /**
      * Deletes an admission record from a specific department if it exists.
+     * Returns true if a record was removed.
      */
-    void deleteAdmission(Admissions::Department dept, const std::string &dateTime)
+    bool deleteAdmission(Admissions::Department dept, const std::string &dateTime)
     {
-        auto &dates = admissions[dept];
-        auto it = std::find(dates.begin(), dates.end(), dateTime);
-        if (it != dates.end())
-        {
-            dates.erase(it);
-
-            // If no more admissions remain for this department, remove the department from the map
-            if (dates.empty())
-            {
-                admissions.erase(dept);
-            }
-            saveToFile();
-        }
+        return admissions.remove(dept, AdmissionLog::toTime(dateTime));
+    }
+
+    /**
+     * Descriptors of the scalar record fields (everything but id, role, createdAt and admissions).
+     * Age and BMI are derived from the IC number, height and weight, so the update form does not edit them.
+     */
+    static const FieldTable<Patient, 18> &fieldTable()
+    {
+        static constexpr FieldTable<Patient, 18> table({{
+            // Personal information
+            {"username", &Patient::username},
+            {"password", &Patient::password},
+            {"fullName", &Patient::fullName},
+            {"age", &Patient::age, false},
+            {"religion", &Patient::religion},
+            {"nationality", &Patient::nationality},
+            {"identityCardNumber", &Patient::identityCardNumber},
+            {"maritalStatus", &Patient::maritalStatus},
+            {"gender", &Patient::gender},
+            {"race", &Patient::race},
+
+            // Contact information
+            {"contactNumber", &Patient::contactNumber},
+            {"emergencyContactNumber", &Patient::emergencyContactNumber},
+            {"emergencyContactName", &Patient::emergencyContactName},
+            {"email", &Patient::email},
+            {"address", &Patient::address},
+
+            // Medical information
+            {"bmi", &Patient::bmi, false},
+            {"height", &Patient::height},
+            {"weight", &Patient::weight},
+        }});
+        static_assert(table.isPerfect(), "No perfect hash seed for the patient fields");
+        return table;
     }
 
     /**
@@ -96,31 +129,9 @@ public:
         j = json{
             {"id", p.id},
             {"role", p.getRoleToString(p.role)},
-            {"username", p.username},
-            {"password", p.password},
             {"createdAt", p.getCreatedAt()},
-            {"age", p.age},
-            {"fullName", p.fullName},
-            {"religion", p.religion},
-            {"nationality", p.nationality},
-            {"identityCardNumber", p.identityCardNumber},
-            {"maritalStatus", p.maritalStatus},
-            {"gender", p.gender},
-            {"race", p.race},
-            {"contactNumber", p.contactNumber},
-            {"emergencyContactNumber", p.emergencyContactNumber},
-            {"emergencyContactName", p.emergencyContactName},
-            {"email", p.email},
-            {"address", p.address},
-            {"bmi", p.bmi},
-            {"height", p.height},
-            {"weight", p.weight},
-            {"admissions", json::object()}};
-
-        for (const auto &[dept, dates] : p.admissions)
-        {
-            j["admissions"][Admissions::departmentToString(dept)] = dates;
-        }
+            {"admissions", p.admissions.toJson()}};
+        fieldTable().toJson(j, p);
     }
 
     /**
@@ -130,69 +141,16 @@ public:
     {
         p.id = j.at("id").get<std::string>();
         p.role = p.getRoleToEnum(j.at("role").get<std::string>());
-        p.username = j.at("username").get<std::string>();
-        p.password = j.at("password").get<std::string>();
-        p.age = j.at("age").get<int>();
-        p.fullName = j.at("fullName").get<std::string>();
-        p.religion = j.at("religion").get<std::string>();
-        p.nationality = j.at("nationality").get<std::string>();
-        p.identityCardNumber = j.at("identityCardNumber").get<std::string>();
-        p.maritalStatus = j.at("maritalStatus").get<std::string>();
-        p.gender = j.at("gender").get<std::string>();
-        p.race = j.at("race").get<std::string>();
-        p.contactNumber = j.at("contactNumber").get<std::string>();
-        p.emergencyContactNumber = j.at("emergencyContactNumber").get<std::string>();
-        p.emergencyContactName = j.at("emergencyContactName").get<std::string>();
-        p.email = j.at("email").get<std::string>();
-        p.address = j.at("address").get<std::string>();
-        p.bmi = j.at("bmi").get<double>();
-        p.height = j.at("height").get<std::string>();
-        p.weight = j.at("weight").get<std::string>();
-
-        // Deserialize admissions map and sort by createdAt
+        fieldTable().fromJson(j, p);
+
+        // Deserialize the admissions log (dates are ordered by time across departments)
         if (j.contains("admissions"))
         {
-            for (const auto &[deptStr, dateList] : j["admissions"].items())
-            {
-                Admissions::Department dept = Admissions::stringToDepartment(deptStr);
-                p.admissions[dept] = dateList.get<std::vector<std::string>>();
-            }
+            p.admissions = AdmissionLog::fromJson(j["admissions"]);
         }
 
         // Deserialize createdAt
-        std::string createdAtStr = j.at("createdAt").get<std::string>();
-        std::tm tm = {};
-        std::istringstream ss(createdAtStr);
-        ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-
-        if (ss.fail())
-        {
-            throw std::invalid_argument("Invalid date format for createdAt");
-        }
-
-        std::time_t time = std::mktime(&tm);
-        p.createdAt = std::chrono::system_clock::from_time_t(time);
-    }
-
-    /**
-     * Saves the Patient object to a JSON file for persistent storage.
-     */
-    void saveToFile() const
-    {
-        std::filesystem::create_directories("db/patient");
-        std::string filePath = "db/patient/" + id + ".json";
-        json j = *this;
-
-        std::ofstream file(filePath);
-        if (file.is_open())
-        {
-            file << j.dump(4);
-            file.close();
-        }
-        else
-        {
-            std::cerr << "Error: Could not open file to save patient data." << std::endl;
-        }
+        p.createdAt = parseTimestamp(j.at("createdAt").get<std::string>());
     }
 };
 
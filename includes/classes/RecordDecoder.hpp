@@ -0,0 +1,425 @@
+#ifndef RECORD_DECODER_H
+#define RECORD_DECODER_H
+
+// Standard library headers
+#include <string>		 // Provides std::string for keys and field values
+#include <stdexcept>	 // Provides std::invalid_argument for malformed records
+#include <filesystem>	 // Provides std::filesystem::path for record files
+#include <cstdint>		 // Provides the bit mask of fields seen so far
+
+#include "json.hpp"		  // SAX interface shared by the JSON, CBOR and MessagePack parsers
+#include "User.hpp"		  // UserSummary and the base fields of every record
+#include "Admin.hpp"	  // Admin records
+#include "Patient.hpp"	  // Patient records and their admissions log
+#include "RecordFile.hpp" // Reads record files and tells their format
+
+using json = nlohmann::json;
+
+// The RecordDecoder class decodes a record file straight into an Admin, Patient or UserSummary
+// (SnapshotDecoder drives it the same way over each record of a checkpoint snapshot).
+// It receives the parser's SAX events and moves each value into its member as it is read, so no
+// intermediate json document is built. Besides id, role, createdAt and admissions, the keys it reads
+// are those of the target's field table (Admin::fieldTable, Patient::fieldTable or the summary's
+// username and full name), and each value goes to the member its descriptor names. Other keys are
+// skipped; for summaries the admission dates are only counted per department, or taken from the
+// admissionCounts of a summary written by UserSummary::toJson. It reports the same
+// problems from_json does: a missing required field, a value of the wrong type, an unknown role or
+// department and a malformed timestamp.
+class RecordDecoder
+{
+private:
+	// Keys every record has outside its field table; any other key is looked up in the target's table
+	enum Key
+	{
+		Unknown = -1,
+		Id,
+		RoleKey,
+		CreatedAt,
+		AdmissionsKey,
+		AdmissionCountsKey,
+		TableField // Field tableIndex of the target's table
+	};
+
+	// Bit of a key in the required/seen masks: the keys above first, then the table fields in table order
+	static constexpr int tableBit = TableField;
+
+	// Required keys of a target: id, role, createdAt and every field of its table (admissions are optional)
+	template <typename T, size_t N>
+	static constexpr std::uint32_t requiredFields(const FieldTable<T, N> &)
+	{
+		static_assert(tableBit + N <= 32, "Too many fields for the seen mask");
+		return 1u << Id | 1u << RoleKey | 1u << CreatedAt | ((std::uint32_t(1) << N) - 1) << tableBit;
+	}
+
+	// Fields of a summary that come from the record's table fields
+	static const FieldTable<UserSummary, 2> &summaryTable()
+	{
+		static constexpr FieldTable<UserSummary, 2> table({{
+			{"username", &UserSummary::username},
+			{"fullName", &UserSummary::fullName},
+		}});
+		static_assert(table.isPerfect(), "No perfect hash seed for the summary fields");
+		return table;
+	}
+
+	const std::filesystem::path *source = nullptr; // File being decoded, for error messages
+	User *user = nullptr;			// Target for the id, role and createdAt of Admin and Patient records
+	Admin *admin = nullptr;			// Target for the table fields of an admin
+	Patient *patient = nullptr;		// Target for the table fields and admissions of a patient
+	UserSummary *summary = nullptr; // Target when only a summary is wanted
+	std::uint32_t required = 0;		// Fields the record must contain
+	std::uint32_t seen = 0;			// Fields read so far
+
+	int depth = 0;								   // Current object/array nesting (1 = top-level record)
+	Key field = Unknown;						   // Key whose value comes next at depth 1
+	int tableIndex = 0;							   // Table field whose value comes next (field == TableField)
+	bool inAdmissions = false;					   // Inside the admissions object of a patient
+	bool inCounts = false;						   // Inside the admissionCounts object of a summary
+	bool admissionDates = false;				   // Reading the date list of admissionDept (patients)
+	Admissions::Department admissionDept{};		   // Department whose dates are being read
+	int *admissionCount = nullptr;				   // Admission count of the department being read (summaries)
+
+	// Bit of the current key in the required/seen masks
+	std::uint32_t bit() const { return std::uint32_t(1) << (field == TableField ? tableBit + tableIndex : field); }
+
+	// Call f with the field table of the target and the object it fills
+	template <typename F>
+	void withTable(F &&f)
+	{
+		if (summary)
+			f(summaryTable(), *summary);
+		else if (patient)
+			f(Patient::fieldTable(), *patient);
+		else
+			f(Admin::fieldTable(), *admin);
+	}
+
+	// Make the field of a table with the given name the current field, if the table has one
+	template <typename T, size_t N>
+	void findField(const FieldTable<T, N> &table, const std::string &name)
+	{
+		if (const FieldDescriptor<T> *descriptor = table.find(name))
+		{
+			field = TableField;
+			tableIndex = static_cast<int>(descriptor - table.begin());
+		}
+	}
+
+	// Store a string in the current field of a table, which must be a text field
+	template <typename T, size_t N>
+	void setText(const FieldTable<T, N> &table, T &target, std::string &value)
+	{
+		const FieldDescriptor<T> &descriptor = table.begin()[tableIndex];
+		if (!descriptor.text)
+			wrongType();
+		target.*descriptor.text = std::move(value);
+	}
+
+	// Store a number in the current field of a table (integer and floating-point fields accept both,
+	// like get<int>/get<double>)
+	template <typename T, size_t N>
+	void setNumber(const FieldTable<T, N> &table, T &target, double value)
+	{
+		const FieldDescriptor<T> &descriptor = table.begin()[tableIndex];
+		if (descriptor.integer)
+			target.*descriptor.integer = static_cast<int>(value);
+		else if (descriptor.real)
+			target.*descriptor.real = value;
+		else
+			wrongType();
+	}
+
+	// Look up the key named by a top-level name
+	void lookup(const std::string &name)
+	{
+		if (name == "id")
+			field = Id;
+		else if (name == "role")
+			field = RoleKey;
+		else if (name == "createdAt")
+			field = CreatedAt;
+		else if (name == "admissions")
+			field = AdmissionsKey;
+		else if (name == "admissionCounts")
+			field = AdmissionCountsKey;
+		else
+		{
+			field = Unknown;
+			withTable([this, &name](const auto &table, auto &)
+					  { findField(table, name); });
+		}
+	}
+
+	// Check whether the current top-level value is wanted by the target
+	bool wanted() const
+	{
+		return depth == 1 && field != Unknown && (required & bit());
+	}
+
+	// Reject a top-level value whose type does not match its field
+	[[noreturn]] void wrongType() const
+	{
+		throw std::invalid_argument("Unexpected value type in record " + source->string());
+	}
+
+	// Store a numeric top-level value in its table field, or a summary's count of one department
+	void setNumber(double value)
+	{
+		if (depth == 2 && inCounts && admissionCount)
+		{
+			*admissionCount = static_cast<int>(value);
+			admissionCount = nullptr;
+			return;
+		}
+		if (admissionDates || admissionCount)
+			wrongType();
+		if (!wanted())
+			return;
+		if (field != TableField)
+			wrongType();
+		withTable([this, value](const auto &table, auto &target)
+				  { setNumber(table, target, value); });
+		seen |= bit();
+	}
+
+	// Store a scalar that no field accepts (null, boolean, binary)
+	bool rejectScalar()
+	{
+		if (wanted() || admissionDates || admissionCount)
+			wrongType();
+		return true;
+	}
+
+	// Point the decoder at the object a record fills
+	void start(Admin &target)
+	{
+		user = &target;
+		admin = &target;
+		required = requiredFields(Admin::fieldTable());
+	}
+
+	void start(Patient &target)
+	{
+		user = &target;
+		patient = &target;
+		required = requiredFields(Patient::fieldTable());
+	}
+
+	void start(UserSummary &target)
+	{
+		summary = &target;
+		required = requiredFields(summaryTable());
+	}
+
+	// Check that the record held every required field, once its last event was received
+	void finish()
+	{
+		std::uint32_t missing = required & ~seen;
+		if (missing)
+		{
+			throw std::invalid_argument("Record " + source->string() + " is missing required fields");
+		}
+		if (patient)
+		{
+			patient->admissions.sort(); // Dates were appended department by department
+		}
+	}
+
+	// Check a record decoded into a Patient that turned out to hold an admin, and move its fields into
+	// target. Only the admin's fields are required; they are a subset of the patient's, so each was
+	// stored in the member the admin has too.
+	void finishAs(Admin &target)
+	{
+		std::uint32_t needed = required & ((std::uint32_t(1) << tableBit) - 1); // id, role and createdAt
+		for (const FieldDescriptor<Admin> &descriptor : Admin::fieldTable())
+		{
+			const FieldDescriptor<Patient> *same = Patient::fieldTable().find(descriptor.name);
+			needed |= std::uint32_t(1) << (tableBit + (same - Patient::fieldTable().begin()));
+		}
+		if (needed & ~seen)
+		{
+			throw std::invalid_argument("Record " + source->string() + " is missing required fields");
+		}
+		static_cast<User &>(target) = std::move(static_cast<User &>(*patient));
+	}
+
+	// Run the parser over one record file
+	void run(const std::filesystem::path &filePath)
+	{
+		source = &filePath;
+		std::string bytes = RecordFile::readBytes(filePath);
+		json::sax_parse(bytes, this, RecordFile::inputFormat(filePath));
+		finish();
+	}
+
+	friend class SnapshotDecoder; // Decodes each record of a checkpoint snapshot the same way
+	friend class LogRecordDecoder; // Decodes the user held by a create record of the change log
+
+public:
+	// SAX events (see nlohmann::json_sax); every handler returns true to keep parsing
+
+	bool null() { return rejectScalar(); }
+	bool boolean(bool) { return rejectScalar(); }
+	bool binary(json::binary_t &) { return rejectScalar(); }
+	bool number_integer(json::number_integer_t value) { setNumber(static_cast<double>(value)); return true; }
+	bool number_unsigned(json::number_unsigned_t value) { setNumber(static_cast<double>(value)); return true; }
+	bool number_float(json::number_float_t value, const json::string_t &) { setNumber(value); return true; }
+
+	bool string(json::string_t &value)
+	{
+		if (depth == 3 && admissionDates)
+		{
+			patient->admissions.append(admissionDept, AdmissionLog::toTime(value));
+			return true;
+		}
+		if (depth == 3 && admissionCount)
+		{
+			++*admissionCount;
+			return true;
+		}
+		if (!wanted())
+			return true;
+
+		if (field == Id)
+		{
+			if (summary)
+				summary->id = std::move(value);
+			else
+				user->id = std::move(value);
+		}
+		else if (field == RoleKey)
+		{
+			Role role = User::getRoleToEnum(value);
+			if (summary)
+				summary->role = role;
+			else
+				user->role = role;
+		}
+		else if (field == CreatedAt)
+		{
+			auto createdAt = parseTimestamp(value);
+			if (summary)
+				summary->createdAt = createdAt;
+			else
+				user->createdAt = createdAt;
+		}
+		else if (field == TableField)
+		{
+			withTable([this, &value](const auto &table, auto &target)
+					  { setText(table, target, value); });
+		}
+		else
+		{
+			wrongType();
+		}
+		seen |= bit();
+		return true;
+	}
+
+	bool start_object(std::size_t)
+	{
+		++depth;
+		if (depth == 2 && field == AdmissionsKey && (patient || summary))
+		{
+			inAdmissions = true;
+		}
+		else if (depth == 2 && field == AdmissionCountsKey && summary)
+		{
+			inCounts = true;
+		}
+		else if (depth == 2 && wanted())
+		{
+			wrongType();
+		}
+		return true;
+	}
+
+	bool key(json::string_t &name)
+	{
+		if (depth == 1)
+		{
+			lookup(name);
+		}
+		else if (depth == 2 && inCounts)
+		{
+			admissionCount = &summary->admissionCounts[Admissions::stringToDepartment(name)];
+		}
+		else if (depth == 2 && inAdmissions && summary)
+		{
+			admissionCount = &summary->admissionCounts[Admissions::stringToDepartment(name)];
+			*admissionCount = 0;
+		}
+		else if (depth == 2 && inAdmissions)
+		{
+			admissionDept = Admissions::stringToDepartment(name);
+			admissionDates = true;
+		}
+		return true;
+	}
+
+	bool end_object()
+	{
+		--depth;
+		if (depth == 1)
+		{
+			inAdmissions = false;
+			inCounts = false;
+		}
+		return true;
+	}
+
+	bool start_array(std::size_t)
+	{
+		++depth;
+		if (depth == 2 && wanted())
+		{
+			wrongType();
+		}
+		return true;
+	}
+
+	bool end_array()
+	{
+		--depth;
+		if (depth == 2)
+		{
+			admissionDates = false;
+			admissionCount = nullptr;
+		}
+		return true;
+	}
+
+	// The parsers pass the concrete exception (json::parse_error, json::out_of_range), so it is thrown as
+	// that type rather than sliced to nlohmann::detail::exception, and callers can catch it as from_json's
+	template <typename Exception>
+	bool parse_error(std::size_t, const std::string &, const Exception &ex)
+	{
+		throw ex;
+	}
+
+	// Decode an admin record file
+	static void decode(const std::filesystem::path &filePath, Admin &admin)
+	{
+		RecordDecoder decoder;
+		decoder.start(admin);
+		decoder.run(filePath);
+	}
+
+	// Decode a patient record file, including its admissions log
+	static void decode(const std::filesystem::path &filePath, Patient &patient)
+	{
+		RecordDecoder decoder;
+		decoder.start(patient);
+		decoder.run(filePath);
+	}
+
+	// Decode only the summary fields and admission counts of a record file; everything else is skipped
+	static void decode(const std::filesystem::path &filePath, UserSummary &summary)
+	{
+		RecordDecoder decoder;
+		decoder.start(summary);
+		decoder.run(filePath);
+	}
+};
+
+#endif // RECORD_DECODER_H
@@ -0,0 +1,372 @@
+#ifndef RECORD_FILE_H
+#define RECORD_FILE_H
+
+// Standard library headers
+#include <string>	  // Provides std::string for roles, IDs and paths
+#include <vector>	  // Holds the raw bytes of binary records
+#include <set>		  // Collects the directories to sync after a layout migration
+#include <iostream>	  // Provides std::cerr for error reporting
+#include <fstream>	  // Reads and writes record files
+#include <filesystem> // Supports probing, listing and removing record files
+#include <stdexcept>  // Provides std::runtime_error for unreadable records
+
+#include "json.hpp"	  // Records are serialized through nlohmann::json in every format
+#include "Config.hpp" // Provides the configured RecordFormat
+#include "RecordSync.hpp" // Replaces record files atomically under the configured durability policy
+#include "FileSync.hpp"	  // Records a layout migration in progress and syncs the directories it touched
+
+using json = nlohmann::json;
+
+// The RecordFile struct reads and writes single user records under db/<role>/<id>.<ext>, or under
+// db/<role>/<shard>/<id>.<ext> in the sharded layout, where the shard is the first two characters of the ID.
+// Records are written in the configured format; files in any supported format are read back,
+// the format being chosen by the file extension.
+struct RecordFile
+{
+	// File extension used for a record format
+	static std::string extension(RecordFormat format)
+	{
+		switch (format)
+		{
+		case RecordFormat::Cbor:
+			return ".cbor";
+		case RecordFormat::MessagePack:
+			return ".msgpack";
+		default:
+			return ".json";
+		}
+	}
+
+	// All supported formats, the configured one first so it is probed before the others
+	static std::vector<RecordFormat> formats()
+	{
+		RecordFormat preferred = Config::getInstance().recordFormat;
+		std::vector<RecordFormat> res = {preferred};
+		for (RecordFormat format : {RecordFormat::Json, RecordFormat::Cbor, RecordFormat::MessagePack})
+		{
+			if (format != preferred)
+				res.push_back(format);
+		}
+		return res;
+	}
+
+	// Check whether a path has the extension of a supported record format
+	static bool isRecordFile(const std::filesystem::path &path)
+	{
+		std::string ext = path.extension().string();
+		return ext == ".json" || ext == ".cbor" || ext == ".msgpack";
+	}
+
+	// Shard directory name of a record: the first two characters of its ID (IDs are UUIDs, so 256 shards)
+	static std::string shard(const std::string &id)
+	{
+		return id.size() >= 2 ? id.substr(0, 2) : "__";
+	}
+
+	// Directory holding a record in the given layout
+	static std::string directory(const std::string &role, const std::string &id, RecordLayout layout)
+	{
+		if (layout == RecordLayout::Sharded)
+			return "db/" + role + "/" + shard(id);
+		return "db/" + role;
+	}
+
+	// Directory holding a record in the configured layout
+	static std::string directory(const std::string &role, const std::string &id)
+	{
+		return directory(role, id, Config::getInstance().recordLayout);
+	}
+
+	// Path of a record in the given format and layout
+	static std::string path(const std::string &role, const std::string &id, RecordFormat format, RecordLayout layout)
+	{
+		return directory(role, id, layout) + "/" + id + extension(format);
+	}
+
+	// Path of a record in the given format and the configured layout
+	static std::string path(const std::string &role, const std::string &id, RecordFormat format)
+	{
+		return path(role, id, format, Config::getInstance().recordLayout);
+	}
+
+	// Every record file of a role stored in the given layout
+	static std::vector<std::filesystem::path> list(const std::string &role, RecordLayout layout)
+	{
+		std::vector<std::filesystem::path> files;
+		std::string dir = "db/" + role;
+		if (!std::filesystem::is_directory(dir))
+			return files;
+
+		for (const auto &entry : std::filesystem::directory_iterator(dir))
+		{
+			if (layout == RecordLayout::Flat)
+			{
+				if (isRecordFile(entry.path()))
+					files.push_back(entry.path());
+			}
+			else if (entry.is_directory())
+			{
+				for (const auto &record : std::filesystem::directory_iterator(entry.path()))
+				{
+					if (isRecordFile(record.path()))
+						files.push_back(record.path());
+				}
+			}
+		}
+		return files;
+	}
+
+	// Every record file of a role stored in the configured layout
+	static std::vector<std::filesystem::path> list(const std::string &role)
+	{
+		return list(role, Config::getInstance().recordLayout);
+	}
+
+	// Check whether a role has at least one record stored in the given layout; stops at the first one
+	static bool hasRecords(const std::string &role, RecordLayout layout)
+	{
+		std::string dir = "db/" + role;
+		if (!std::filesystem::is_directory(dir))
+			return false;
+
+		for (const auto &entry : std::filesystem::directory_iterator(dir))
+		{
+			if (layout == RecordLayout::Flat)
+			{
+				if (isRecordFile(entry.path()))
+					return true;
+			}
+			else if (entry.is_directory())
+			{
+				for (const auto &record : std::filesystem::directory_iterator(entry.path()))
+				{
+					if (isRecordFile(record.path()))
+						return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	// Delete the staged files a crash left behind in a role's directory, in either layout.
+	// Staged writes still pending in this process are renamed into place first. Returns the number deleted.
+	static int removeStaged(const std::string &role)
+	{
+		int removed = 0;
+		std::string dir = "db/" + role;
+		if (!std::filesystem::is_directory(dir))
+			return removed;
+
+		RecordSync::getInstance().flush();
+		std::error_code ec;
+		for (const auto &entry : std::filesystem::recursive_directory_iterator(dir, ec))
+		{
+			if (entry.is_regular_file() && RecordSync::isStaged(entry.path()) && std::filesystem::remove(entry.path(), ec))
+				++removed;
+		}
+		return removed;
+	}
+
+	// Find the file holding a record in any format; returns an empty path if there is none
+	static std::filesystem::path find(const std::string &role, const std::string &id)
+	{
+		for (RecordFormat format : formats())
+		{
+			std::string candidate = path(role, id, format);
+			RecordSync::getInstance().flush(candidate); // A staged write of the record must be in place before it is read
+			if (std::filesystem::exists(candidate))
+				return candidate;
+		}
+		return {};
+	}
+
+	// Parser input format matching a record file's extension
+	static json::input_format_t inputFormat(const std::filesystem::path &filePath)
+	{
+		std::string ext = filePath.extension().string();
+		if (ext == ".cbor")
+			return json::input_format_t::cbor;
+		if (ext == ".msgpack")
+			return json::input_format_t::msgpack;
+		return json::input_format_t::json;
+	}
+
+	// Read a whole record file in one call so that it can be parsed from memory
+	static std::string readBytes(const std::filesystem::path &filePath)
+	{
+		std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+		if (!file.is_open())
+			throw std::runtime_error("Could not open record file " + filePath.string());
+
+		std::string bytes(static_cast<size_t>(file.tellg()), '\0');
+		file.seekg(0);
+		file.read(&bytes[0], static_cast<std::streamsize>(bytes.size()));
+		return bytes;
+	}
+
+	// Parse a record file in the format given by its extension
+	static json read(const std::filesystem::path &filePath)
+	{
+		std::string bytes = readBytes(filePath);
+		switch (inputFormat(filePath))
+		{
+		case json::input_format_t::cbor:
+			return json::from_cbor(bytes);
+		case json::input_format_t::msgpack:
+			return json::from_msgpack(bytes);
+		default:
+			return json::parse(bytes);
+		}
+	}
+
+	// Serialize a record in the given format
+	static std::string serialize(const json &j, RecordFormat format)
+	{
+		std::vector<std::uint8_t> bytes;
+		switch (format)
+		{
+		case RecordFormat::Cbor:
+			bytes = json::to_cbor(j);
+			break;
+		case RecordFormat::MessagePack:
+			bytes = json::to_msgpack(j);
+			break;
+		default:
+			return Config::getInstance().prettyJson ? j.dump(4) : j.dump();
+		}
+		return std::string(bytes.begin(), bytes.end());
+	}
+
+	// Write a record in the given format and remove any copy left in another format
+	static bool write(const std::string &role, const std::string &id, const json &j, RecordFormat format)
+	{
+		RecordSync &sync = RecordSync::getInstance();
+		if (!sync.write(directory(role, id), path(role, id, format), serialize(j, format)))
+			return false;
+
+		for (RecordFormat other : formats())
+		{
+			std::string otherPath = path(role, id, other);
+			if (other != format && std::filesystem::exists(otherPath))
+			{
+				sync.flush(path(role, id, format)); // The new copy must be in place before the old one goes
+				std::error_code ec;
+				std::filesystem::remove(otherPath, ec);
+			}
+		}
+		return true;
+	}
+
+	// Write a record in the configured format
+	static bool write(const std::string &role, const std::string &id, const json &j)
+	{
+		return write(role, id, j, Config::getInstance().recordFormat);
+	}
+
+	// Remove a record; returns true if a file was removed.
+	// A record is written in one format only, so removal stops at the first format that had a file
+	// and the configured format is tried first: a delete normally costs a single unlink.
+	static bool remove(const std::string &role, const std::string &id)
+	{
+		for (RecordFormat format : formats())
+		{
+			std::string filePath = path(role, id, format);
+			RecordSync::getInstance().discard(filePath);
+			std::error_code ec;
+			if (std::filesystem::remove(filePath, ec))
+				return true;
+			if (ec)
+				std::cerr << "Error deleting file " << filePath << ": " << ec.message() << std::endl;
+		}
+		return false;
+	}
+
+	// Rewrite every record under db/admin and db/patient in the target format.
+	// Returns the number of records converted.
+	static int migrateAll(RecordFormat target)
+	{
+		int converted = 0;
+		for (const std::string role : {"admin", "patient"})
+		{
+			// The listing is complete before any file is rewritten, so rewriting does not disturb it
+			for (const auto &filePath : list(role))
+			{
+				if (filePath.extension() != extension(target) && write(role, filePath.stem().string(), read(filePath), target))
+					++converted;
+			}
+		}
+		return converted;
+	}
+
+	// Present from the start of a layout migration until every record has been moved
+	static constexpr const char *layoutMigrationPath = "db/layout.migrating";
+
+	// Check whether a layout migration was started and has not finished, leaving records in both layouts
+	static bool isMigratingLayout()
+	{
+		return std::filesystem::exists(layoutMigrationPath);
+	}
+
+	// Move every record under db/admin and db/patient into the target layout by renaming it,
+	// then remove the shard directories left empty. Returns the number of records moved.
+	// The migration is recorded in layoutMigrationPath until every record has moved: a record that
+	// cannot be moved is reported and skipped, and the run then throws std::runtime_error, leaving the
+	// marker so that startup refuses the split store. Running it again moves the remaining records.
+	static int migrateLayout(RecordLayout target)
+	{
+		RecordLayout source = target == RecordLayout::Flat ? RecordLayout::Sharded : RecordLayout::Flat;
+		std::filesystem::create_directories("db");
+		if (!FileSync::writeFile(layoutMigrationPath, target == RecordLayout::Flat ? "flat\n" : "sharded\n", true) ||
+			!FileSync::syncParent(layoutMigrationPath))
+		{
+			throw std::runtime_error(std::string("Could not write ") + layoutMigrationPath);
+		}
+
+		int moved = 0;
+		int failed = 0;
+		for (const std::string role : {"admin", "patient"})
+		{
+			std::set<std::string> dirs; // Directories a record left or entered, synced once the role is done
+			for (const auto &filePath : list(role, source))
+			{
+				std::string id = filePath.stem().string();
+				std::string dir = directory(role, id, target);
+				try
+				{
+					std::filesystem::create_directories(dir);
+					std::filesystem::rename(filePath, dir + "/" + filePath.filename().string());
+					dirs.insert(dir);
+					dirs.insert(filePath.parent_path().string());
+					++moved;
+				}
+				catch (const std::filesystem::filesystem_error &e)
+				{
+					std::cerr << "Error: Could not move record file " << filePath.string() << ": " << e.what() << std::endl;
+					++failed;
+				}
+			}
+			for (const std::string &dir : dirs)
+				FileSync::syncDirectory(dir);
+
+			if (target == RecordLayout::Flat && std::filesystem::is_directory("db/" + role))
+			{
+				for (const auto &entry : std::filesystem::directory_iterator("db/" + role))
+				{
+					std::error_code ec;
+					if (entry.is_directory())
+						std::filesystem::remove(entry.path(), ec); // Only succeeds for empty shards
+				}
+			}
+		}
+
+		if (failed > 0)
+		{
+			throw std::runtime_error(std::to_string(failed) + " record file(s) could not be moved (" + std::to_string(moved) +
+									 " were); run --migrate-layout again to move the rest");
+		}
+		std::filesystem::remove(layoutMigrationPath);
+		return moved;
+	}
+};
+
+#endif // RECORD_FILE_H
@@ -0,0 +1,268 @@
+#ifndef RECORD_LOG_H
+#define RECORD_LOG_H
+
+// Standard library headers
+#include <string>			  // Provides std::string for the log path and pending buffer
+#include <iostream>			  // Provides std::cerr for error reporting
+#include <fstream>			  // Used to read the log back during replay
+#include <filesystem>		  // Supports creating the log directory and trimming torn tails
+#include <functional>		  // Provides std::function for the replay callback
+#include <stdexcept>		  // Provides std::runtime_error for corrupt records found during replay
+#include <thread>			  // Runs the background group-commit thread
+#include <mutex>			  // Guards the pending buffer shared with the commit thread
+#include <condition_variable> // Wakes the commit thread early when the buffer fills up
+#include <chrono>			  // Provides the group-commit interval
+#include <cstdint>			  // Provides fixed-width sequence numbers
+
+// POSIX headers for appending to and syncing the log file
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "json.hpp"	   // Change records are serialized as compact single-line JSON
+#include "FileSync.hpp" // Writes and syncs the log and the directory holding it
+
+using json = nlohmann::json;
+
+// The RecordLog class is an append-only log of compact change records (one JSON object per line).
+// Appends only touch an in-memory buffer; a background thread writes and syncs the buffered
+// records in one sequential batch every groupCommitMs (group commit).
+// Every record carries an increasing "seq" so that a checkpoint can say which records it already covers.
+class RecordLog
+{
+private:
+	std::string path;		  // Path of the log file
+	int fd = -1;			  // File descriptor opened in append mode
+	int groupCommitMs = 50;	  // Maximum time an appended record waits before being synced
+	std::string pending;	  // Serialized records waiting for the next commit
+	std::mutex pendingMutex;  // Guards pending and stopping
+	std::mutex commitMutex;	  // Serializes commits so batches reach the disk in append order
+	std::condition_variable cv;
+	std::thread committer; // Background group-commit thread
+	bool stopping = false;
+	std::uint64_t lastSeq = 0; // Sequence number of the most recently appended record
+
+	// Commit early once this much data is buffered
+	static constexpr size_t maxPendingBytes = 64 * 1024;
+
+	// Write the pending batch to the log and sync it to disk; returns false if it is not durable.
+	// A failed batch is put back in front of pending for the next commit, and the log is cut back
+	// to where the batch began so that no part of it is written twice.
+	bool commit()
+	{
+		std::lock_guard<std::mutex> commitLock(commitMutex);
+		std::string batch;
+		{
+			std::lock_guard<std::mutex> lock(pendingMutex);
+			batch.swap(pending);
+		}
+		if (batch.empty())
+			return true;
+
+		off_t start = fd < 0 ? -1 : ::lseek(fd, 0, SEEK_END);
+		bool ok = start >= 0 && FileSync::writeAll(fd, batch.data(), batch.size());
+		ok = ok && ::fdatasync(fd) == 0; // One sync for the whole batch
+		if (ok)
+			return true;
+
+		std::cerr << "Error: Could not append to record log " << path << "; " << batch.size()
+				  << " bytes of changes are kept for the next commit" << std::endl;
+		if (start >= 0 && ::ftruncate(fd, start) != 0)
+			std::cerr << "Error: Could not cut back record log " << path << std::endl;
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		pending.insert(0, batch);
+		return false;
+	}
+
+	// Background loop: commit whatever has accumulated every groupCommitMs.
+	// After a failed commit the full interval passes before the next try, even with a full buffer.
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(pendingMutex);
+		bool failed = false;
+		while (!stopping)
+		{
+			cv.wait_for(lock, std::chrono::milliseconds(groupCommitMs), [this, failed]
+						{ return stopping || (!failed && pending.size() >= maxPendingBytes); });
+			lock.unlock();
+			failed = !commit();
+			lock.lock();
+		}
+	}
+
+public:
+	RecordLog() = default;
+	~RecordLog() { close(); }
+	RecordLog(const RecordLog &) = delete;
+	RecordLog &operator=(const RecordLog &) = delete;
+
+	// Open (or create) the log for appending and start the group-commit thread
+	bool open(const std::string &logPath, int commitIntervalMs)
+	{
+		path = logPath;
+		groupCommitMs = commitIntervalMs;
+		std::filesystem::path parent = std::filesystem::path(path).parent_path();
+		if (!parent.empty())
+			std::filesystem::create_directories(parent);
+
+		fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+		if (fd < 0)
+		{
+			std::cerr << "Error: Could not open record log " << path << std::endl;
+			return false;
+		}
+		stopping = false;
+		committer = std::thread(&RecordLog::run, this);
+		return true;
+	}
+
+	// Check whether the log is open for appending
+	bool isOpen() const { return fd >= 0; }
+
+	// Check whether appended records are still waiting to be committed
+	bool hasPending()
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		return !pending.empty();
+	}
+
+	// Queue a change record; it reaches the disk with the next group commit
+	void append(json record)
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		record["seq"] = ++lastSeq;
+		pending += record.dump();
+		pending += '\n';
+		if (pending.size() >= maxPendingBytes)
+			cv.notify_one();
+	}
+
+	// Sequence number of the most recently appended record
+	std::uint64_t getLastSeq()
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		return lastSeq;
+	}
+
+	// Continue numbering after the given sequence number (set after replaying the log)
+	void setLastSeq(std::uint64_t seq)
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		lastSeq = seq;
+	}
+
+	// Drop every committed record with seq <= throughSeq (they are covered by a checkpoint).
+	// The surviving tail is written to a synced temporary file that atomically replaces the log,
+	// and the directory is synced so the replacement survives a crash.
+	bool compactThrough(std::uint64_t throughSeq)
+	{
+		std::lock_guard<std::mutex> commitLock(commitMutex); // No batch may be written while the file is swapped
+		if (fd < 0)
+			return false;
+
+		std::string tail;
+		std::ifstream in(path);
+		std::string line;
+		while (std::getline(in, line))
+		{
+			if (line.empty())
+				continue;
+			json record = json::parse(line, nullptr, false);
+			if (!record.is_discarded() && record.value("seq", std::uint64_t(0)) > throughSeq)
+			{
+				tail += line;
+				tail += '\n';
+			}
+		}
+		in.close();
+
+		std::string tmpPath = path + ".tmp";
+		if (!FileSync::writeFile(tmpPath, tail, true) || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+		{
+			std::filesystem::remove(tmpPath);
+			std::cerr << "Error: Could not compact record log " << path << std::endl;
+			return false;
+		}
+		bool durable = FileSync::syncParent(path);
+		if (!durable)
+			std::cerr << "Error: Could not sync the directory of record log " << path << std::endl;
+
+		// Reopen so later appends go to the compacted file
+		::close(fd);
+		fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+		return fd >= 0 && durable;
+	}
+
+	// Synchronously commit everything appended so far; returns false if it did not reach the disk
+	bool flush()
+	{
+		return commit();
+	}
+
+	// Stop the commit thread, commit the remaining records and close the file
+	void close()
+	{
+		if (committer.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(pendingMutex);
+				stopping = true;
+			}
+			cv.notify_one();
+			committer.join();
+		}
+		commit();
+		if (fd >= 0)
+		{
+			::close(fd);
+			fd = -1;
+		}
+	}
+
+	// Feed every record line in the log to apply, in append order; apply decodes the line itself.
+	// Only a last line without its trailing newline (an append a crash cut short) is cut off, so
+	// later appends stay readable. A complete line that apply rejects, because it does not parse or
+	// does not describe a valid change, is corruption rather than a torn append: replay throws
+	// std::runtime_error naming the line and leaves the log untouched.
+	static void replay(const std::string &logPath, const std::function<void(const std::string &)> &apply)
+	{
+		std::ifstream file(logPath);
+		if (!file.is_open())
+			return;
+
+		std::string line;
+		std::uintmax_t validBytes = 0;
+		size_t lineNumber = 0;
+		bool torn = false;
+		while (std::getline(file, line))
+		{
+			++lineNumber;
+			if (file.eof()) // Last line has no trailing newline, so its append never completed
+			{
+				torn = true;
+				break;
+			}
+			if (!line.empty())
+			{
+				try
+				{
+					apply(line);
+				}
+				catch (const std::exception &e)
+				{
+					throw std::runtime_error("Could not replay the record at line " + std::to_string(lineNumber) + " of " +
+											 logPath + ": " + e.what());
+				}
+			}
+			validBytes += line.size() + 1;
+		}
+		file.close();
+
+		if (torn)
+		{
+			std::cerr << "Warning: Discarding an incomplete record at the end of " << logPath << std::endl;
+			std::filesystem::resize_file(logPath, validBytes);
+		}
+	}
+};
+
+#endif // RECORD_LOG_H
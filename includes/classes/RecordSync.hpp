@@ -0,0 +1,219 @@
+#ifndef RECORD_SYNC_H
+#define RECORD_SYNC_H
+
+// Standard library headers
+#include <string>			  // Provides std::string for file paths
+#include <unordered_map>	  // Maps each record path to its latest staged file
+#include <vector>			  // Lists the staged files of a batch
+#include <set>				  // Collects the directories to sync after a batch
+#include <iostream>			  // Provides std::cerr for error reporting
+#include <filesystem>		  // Supports creating record directories and removing staged files
+#include <thread>			  // Runs the background group-sync thread
+#include <mutex>			  // Guards the staged files shared with the sync thread
+#include <condition_variable> // Wakes the sync thread on its interval or at shutdown
+#include <chrono>			  // Provides the group-sync interval
+#include <cstdint>			  // Provides the staged file counter
+#include <cstdio>			  // Provides std::rename for atomic replacement
+
+#include "Config.hpp"	// Provides the durability policy and the group-sync interval
+#include "FileSync.hpp" // Writes and syncs staged files and their directories
+
+// The RecordSync class replaces record files atomically: every write goes to a staged file next to
+// the record, which is renamed over it once complete, so a crash never leaves a half-written record.
+// When the staged file is synced depends on the durability policy:
+//   Sync  - synced and renamed before write returns, then the directory is synced;
+//   Group - renamed by a background thread every groupCommitMs after one sync per staged file and
+//           per directory; a record saved again before then replaces its staged file unsynced;
+//   None  - renamed at once and never synced (the operating system writes it back later).
+class RecordSync
+{
+private:
+	struct Staged
+	{
+		std::string stagedPath; // Complete but not yet renamed copy of the record
+		std::string dir;		// Directory of the record, synced after the rename
+	};
+
+	Durability durability;
+	int groupCommitMs;
+	std::uint64_t nextStage = 0;						   // Makes every staged file name unique
+	std::unordered_map<std::string, Staged> pending;	   // Record path -> latest staged file
+	std::unordered_map<std::string, Staged> syncing;	   // Batch currently being synced by the thread
+	std::mutex stagedMutex;								   // Guards nextStage, pending and syncing
+	std::mutex commitMutex;								   // Serializes batches so renames keep their order
+	std::condition_variable cv;
+	std::thread syncer;
+	bool stopping = false;
+
+	// Sync every pending staged file, rename it over its record, then sync each touched directory once
+	void commit()
+	{
+		std::lock_guard<std::mutex> commitLock(commitMutex);
+		std::vector<std::string> stagedPaths;
+		{
+			std::lock_guard<std::mutex> lock(stagedMutex);
+			syncing.swap(pending);
+			for (const auto &[filePath, staged] : syncing)
+				stagedPaths.push_back(staged.stagedPath);
+		}
+		if (stagedPaths.empty())
+			return;
+
+		for (const std::string &stagedPath : stagedPaths)
+			FileSync::syncFile(stagedPath);
+
+		std::set<std::string> dirs;
+		{
+			// Renamed under the lock so that a record deleted meanwhile (see discard) stays deleted
+			std::lock_guard<std::mutex> lock(stagedMutex);
+			for (const auto &[filePath, staged] : syncing)
+			{
+				if (std::rename(staged.stagedPath.c_str(), filePath.c_str()) == 0)
+					dirs.insert(staged.dir);
+				else
+					std::cerr << "Error: Could not replace record file " << filePath << std::endl;
+			}
+			syncing.clear();
+		}
+		for (const std::string &dir : dirs)
+			FileSync::syncDirectory(dir);
+	}
+
+	// Background loop: commit the staged files every groupCommitMs until shutdown
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(stagedMutex);
+		while (!stopping)
+		{
+			cv.wait_for(lock, std::chrono::milliseconds(groupCommitMs), [this]
+						{ return stopping; });
+			lock.unlock();
+			commit();
+			lock.lock();
+		}
+	}
+
+public:
+	RecordSync(Durability durability, int groupCommitMs) : durability(durability), groupCommitMs(groupCommitMs)
+	{
+		if (durability == Durability::Group)
+			syncer = std::thread(&RecordSync::run, this);
+	}
+	~RecordSync()
+	{
+		if (syncer.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(stagedMutex);
+				stopping = true;
+			}
+			cv.notify_one();
+			syncer.join();
+		}
+		commit();
+	}
+	RecordSync(const RecordSync &) = delete;
+	RecordSync &operator=(const RecordSync &) = delete;
+
+	// Shared instance configured from HMS_DURABILITY and HMS_GROUP_COMMIT_MS
+	static RecordSync &getInstance()
+	{
+		static RecordSync instance(Config::getInstance().durability, Config::getInstance().groupCommitMs);
+		return instance;
+	}
+
+	// Check whether a path is a staged file (an unfinished write, never a record)
+	static bool isStaged(const std::filesystem::path &path)
+	{
+		return path.extension() == ".tmp";
+	}
+
+	// Replace the file at filePath in dir with bytes, creating dir if it is missing
+	bool write(const std::string &dir, const std::string &filePath, const std::string &bytes)
+	{
+		std::string stagedPath;
+		{
+			std::lock_guard<std::mutex> lock(stagedMutex);
+			stagedPath = filePath + "." + std::to_string(++nextStage) + ".tmp";
+		}
+
+		bool sync = durability == Durability::Sync;
+		if (!FileSync::writeFile(stagedPath, bytes, sync))
+		{
+			std::error_code ec;
+			std::filesystem::create_directories(dir, ec);
+			if (!FileSync::writeFile(stagedPath, bytes, sync))
+			{
+				std::filesystem::remove(stagedPath, ec);
+				return false;
+			}
+		}
+
+		if (durability == Durability::Group)
+		{
+			std::lock_guard<std::mutex> lock(stagedMutex);
+			auto it = pending.find(filePath);
+			if (it != pending.end())
+			{
+				std::error_code ec;
+				std::filesystem::remove(it->second.stagedPath, ec); // Superseded before it was ever synced
+				it->second.stagedPath = stagedPath;
+			}
+			else
+			{
+				pending.emplace(filePath, Staged{stagedPath, dir});
+			}
+			return true;
+		}
+
+		if (std::rename(stagedPath.c_str(), filePath.c_str()) != 0)
+		{
+			std::error_code ec;
+			std::filesystem::remove(stagedPath, ec);
+			return false;
+		}
+		if (sync)
+			FileSync::syncDirectory(dir);
+		return true;
+	}
+
+	// Drop a staged write that has not reached filePath yet (its record is being removed)
+	void discard(const std::string &filePath)
+	{
+		std::lock_guard<std::mutex> lock(stagedMutex);
+		for (auto *staged : {&pending, &syncing})
+		{
+			auto it = staged->find(filePath);
+			if (it != staged->end())
+			{
+				std::error_code ec;
+				std::filesystem::remove(it->second.stagedPath, ec);
+				staged->erase(it);
+			}
+		}
+	}
+
+	// Rename every staged write into place now
+	void flush()
+	{
+		{
+			std::lock_guard<std::mutex> lock(stagedMutex);
+			if (pending.empty())
+				return;
+		}
+		commit();
+	}
+
+	// Rename the staged writes into place if one of them is for filePath (before that record is read back)
+	void flush(const std::string &filePath)
+	{
+		{
+			std::lock_guard<std::mutex> lock(stagedMutex);
+			if (pending.count(filePath) == 0 && syncing.count(filePath) == 0)
+				return;
+		}
+		commit(); // Also waits for a batch the thread is still renaming
+	}
+};
+
+#endif // RECORD_SYNC_H
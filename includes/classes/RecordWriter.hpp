@@ -0,0 +1,181 @@
+#ifndef RECORD_WRITER_H
+#define RECORD_WRITER_H
+
+// Standard library headers
+#include <string>			  // Provides std::string for roles and IDs
+#include <unordered_map>	  // Holds the latest queued save of each record
+#include <deque>			  // Keeps the queued records in save order
+#include <memory>			  // Shares the completion promise of a save
+#include <future>			  // Acknowledges completed saves through shared futures
+#include <iostream>			  // Provides std::cerr for error reporting
+#include <thread>			  // Runs the background writer thread
+#include <mutex>			  // Guards the queue shared with the writer thread
+#include <condition_variable> // Wakes the writer, and callers waiting for room or completion
+
+#include "json.hpp"		  // Records are queued as serialized json documents
+#include "RecordFile.hpp" // Writes the record files
+
+using json = nlohmann::json;
+
+// The RecordWriter class writes record files on a background thread so that saving never waits for the disk.
+// The queue holds at most capacity records; a record saved again while it is still queued only replaces the
+// queued document, so several edits of one record cost one write. Each save returns a future that becomes
+// ready once its record file is written (true) or the write failed or was dropped by a delete (false).
+// With a capacity of 0 every save is written on the calling thread.
+class RecordWriter
+{
+private:
+	struct Save
+	{
+		std::string role;
+		std::string id;
+		json record;
+		std::shared_ptr<std::promise<bool>> done;
+		std::shared_future<bool> result;
+	};
+
+	size_t capacity;
+	std::unordered_map<std::string, Save> queued; // role/id -> latest document to write
+	std::deque<std::string> order;				  // Keys in save order (a key dropped from queued is skipped)
+	std::string writing;						  // Key of the record being written, empty when idle
+	bool stopping = false;
+	std::mutex queueMutex; // Guards queued, order, writing and stopping
+	std::condition_variable workCv;
+	std::condition_variable doneCv; // Signalled whenever a write finishes
+	std::thread worker;
+
+	// Queue key of a record
+	static std::string key(const std::string &role, const std::string &id)
+	{
+		return role + "/" + id;
+	}
+
+	// Write the file of a save and acknowledge it
+	static void writeSave(Save &save)
+	{
+		bool ok = RecordFile::write(save.role, save.id, save.record);
+		if (!ok)
+			std::cerr << "Error: Could not save " << save.role << " record " << save.id << "." << std::endl;
+		save.done->set_value(ok);
+	}
+
+	// Background loop: write the queued records in save order until stopped and empty
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(queueMutex);
+		while (true)
+		{
+			workCv.wait(lock, [this]
+						{ return stopping || !order.empty(); });
+			if (order.empty())
+				break; // Stopping with nothing left to write
+
+			std::string next = std::move(order.front());
+			order.pop_front();
+			auto it = queued.find(next);
+			if (it == queued.end())
+				continue; // Already written under an earlier entry, or dropped by a delete
+
+			Save save = std::move(it->second);
+			queued.erase(it);
+			writing = next;
+			lock.unlock();
+			writeSave(save);
+			lock.lock();
+			writing.clear();
+			doneCv.notify_all();
+		}
+	}
+
+	// Wait until the record with the given key is neither queued nor being written
+	void waitFor(std::unique_lock<std::mutex> &lock, const std::string &recordKey)
+	{
+		doneCv.wait(lock, [this, &recordKey]
+					{ return writing != recordKey && queued.count(recordKey) == 0; });
+	}
+
+public:
+	explicit RecordWriter(size_t capacity) : capacity(capacity)
+	{
+		if (capacity > 0)
+			worker = std::thread(&RecordWriter::run, this);
+	}
+	~RecordWriter() { close(); }
+	RecordWriter(const RecordWriter &) = delete;
+	RecordWriter &operator=(const RecordWriter &) = delete;
+
+	// Queue a record file write; blocks only while the queue is full
+	std::shared_future<bool> save(const std::string &role, const std::string &id, json record)
+	{
+		Save save{role, id, std::move(record), std::make_shared<std::promise<bool>>(), {}};
+		save.result = save.done->get_future().share();
+		if (!worker.joinable())
+		{
+			writeSave(save);
+			return save.result;
+		}
+
+		std::string recordKey = key(role, id);
+		std::unique_lock<std::mutex> lock(queueMutex);
+		auto it = queued.find(recordKey);
+		if (it != queued.end())
+		{
+			it->second.record = std::move(save.record); // Coalesce with the save still waiting
+			return it->second.result;
+		}
+
+		doneCv.wait(lock, [this]
+					{ return queued.size() < capacity; });
+		std::shared_future<bool> result = save.result;
+		queued.emplace(recordKey, std::move(save));
+		order.push_back(recordKey);
+		workCv.notify_one();
+		return result;
+	}
+
+	// Wait until the latest save of a record is on disk (before its file is read back)
+	void wait(const std::string &role, const std::string &id)
+	{
+		std::unique_lock<std::mutex> lock(queueMutex);
+		waitFor(lock, key(role, id));
+	}
+
+	// Drop a queued save of a record that is being deleted, and wait for a write already under way
+	void discard(const std::string &role, const std::string &id)
+	{
+		std::string recordKey = key(role, id);
+		std::unique_lock<std::mutex> lock(queueMutex);
+		auto it = queued.find(recordKey);
+		if (it != queued.end())
+		{
+			it->second.done->set_value(false);
+			queued.erase(it);
+			doneCv.notify_all(); // Frees a place in the queue
+		}
+		waitFor(lock, recordKey);
+	}
+
+	// Wait until every queued save is on disk
+	void drain()
+	{
+		std::unique_lock<std::mutex> lock(queueMutex);
+		doneCv.wait(lock, [this]
+					{ return queued.empty() && writing.empty(); });
+	}
+
+	// Write the remaining saves and stop the writer thread
+	void close()
+	{
+		if (worker.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(queueMutex);
+				stopping = true;
+			}
+			workCv.notify_one();
+			worker.join();
+		}
+	}
+};
+
+#endif // RECORD_WRITER_H
@@ -0,0 +1,696 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+// Standard library headers
+#include <string>		 // Provides std::string for queries, field values and document keys
+#include <vector>		 // Holds posting lists and per-document data
+#include <unordered_map> // Maps user IDs to document numbers
+#include <algorithm>	 // Provides sorting, searching and set difference for posting lists
+#include <iterator>		 // Provides std::back_inserter for set differences
+#include <cstdint>		 // Provides fixed-width document numbers
+#include <chrono>		 // Creation timestamps that order the results
+#include <limits>		 // Marks documents without a place in the creation order
+
+#include "User.hpp"	 // UserSummary holds the searchable fields
+#include "utils.hpp" // Provides toLower and trim for normalizing queries
+
+// The SearchIndex class answers case-insensitive substring queries over the ID, username and
+// full name of a set of users through a trigram inverted index.
+// Every indexed user gets a document number. Each trigram (three consecutive characters of one
+// field) has a posting list of the documents containing it, sorted by document number. A query of
+// three or more characters intersects the lists of its trigrams, shortest first, and confirms each
+// candidate against the fields themselves, so only users sharing every trigram with the query are
+// compared. Every single character and pair of adjacent characters also has a bitmap of the
+// documents containing it, so a one- or two-character query is answered by copying one bitmap.
+// The index also keeps every document in creation order (newest first). A query only puts as many
+// matches in that order as the pages read so far need: few matches are partially selected, many
+// are found by walking the creation order until the page is filled. A removed document is cleared
+// from the bitmaps but left in the posting lists and the creation order, where it is skipped; those
+// entries are dropped in one pass once enough have accumulated.
+class SearchIndex
+{
+public:
+	// Users matching a query. The first matches in listing order (newest first, ties by ID) are in
+	// listed; the rest are either kept unordered in unlisted (few matches) or marked in members (many
+	// matches) and found by walking the creation order on from walked. Only meaningful to the index
+	// that produced them and only until a user is added or removed (a removed user's document may
+	// then belong to someone else).
+	struct Matches
+	{
+		size_t total = 0;					 // Number of matches
+		std::vector<std::uint32_t> listed;	 // Leading matches in listing order
+		std::vector<std::uint32_t> unlisted; // Remaining matches in no particular order (few matches)
+		std::vector<std::uint64_t> members;	 // Bitmap of every match by document (many matches)
+		size_t walked = 0;					 // Creation order positions already walked (many matches)
+	};
+
+private:
+	// Characters are folded into a 40-symbol alphabet (case-insensitive letters, digits, ' ', '-',
+	// '.', and one symbol for everything else), so every trigram has a slot in a flat table
+	static constexpr int alphabetSize = 40;
+	static constexpr int otherSymbol = alphabetSize - 1;
+
+	// Grams from trigramCount on are single symbols, then pairs of symbols; they index shortGrams
+	static constexpr std::uint32_t trigramCount = alphabetSize * alphabetSize * alphabetSize;
+	static constexpr std::uint32_t shortGramCount = alphabetSize + alphabetSize * alphabetSize;
+
+	std::unordered_map<std::string, std::uint32_t> docOf; // User ID -> document (its own copy, as summaries get reassigned)
+	std::vector<const UserSummary *> docSummary;		  // Document -> summary (nullptr once removed)
+	std::vector<std::uint32_t> freeDocs;				  // Documents of removed users, reused by the next adds
+	std::vector<std::uint32_t> retiredDocs;				  // Removed documents still in the posting lists or the order, freed by purgeRemoved()
+	std::vector<std::uint32_t> staleGrams;				  // Trigrams whose posting lists hold retired documents (with repeats)
+	std::vector<std::vector<std::uint32_t>> postings;		   // Trigram -> sorted documents containing it
+	std::vector<std::vector<std::uint64_t>> shortGrams;		   // Symbol or pair -> bitmap of the documents containing it (only as long as its last one)
+	std::vector<std::chrono::system_clock::time_point> docCreatedAt; // Document -> creation time, kept flat for ordering
+
+	// Live documents newest first (ties by ID). Documents added since the last query wait in
+	// pendingOrder and are merged in by the next query, so a bulk load costs one sort.
+	mutable std::vector<std::uint32_t> order;
+	mutable std::vector<std::uint32_t> pendingOrder;
+
+	// Document -> its position in order (unplaced while pending), and the sorted positions in order
+	// of removed documents, left in place until compactOrder() drops them
+	static constexpr size_t unplaced = std::numeric_limits<size_t>::max();
+	mutable std::vector<size_t> docPosition;
+	mutable std::vector<size_t> deadAt;
+
+	// Symbol of a character in the folded alphabet
+	static int symbolOf(unsigned char c)
+	{
+		if (c >= 'a' && c <= 'z')
+			return c - 'a';
+		if (c >= 'A' && c <= 'Z')
+			return c - 'A';
+		if (c >= '0' && c <= '9')
+			return 26 + (c - '0');
+		switch (c)
+		{
+		case ' ':
+			return 36;
+		case '-':
+			return 37;
+		case '.':
+			return 38;
+		default:
+			return otherSymbol;
+		}
+	}
+
+	// Append the trigrams of one field
+	static void addTrigrams(const std::string &field, std::vector<std::uint32_t> &grams)
+	{
+		for (size_t i = 0; i + 2 < field.size(); ++i)
+		{
+			grams.push_back(static_cast<std::uint32_t>((symbolOf(field[i]) * alphabetSize + symbolOf(field[i + 1])) * alphabetSize +
+													   symbolOf(field[i + 2])));
+		}
+	}
+
+	// Gram of a one- or two-character text
+	static std::uint32_t shortGramOf(const std::string &text)
+	{
+		int first = symbolOf(text[0]);
+		if (text.size() == 1)
+			return trigramCount + first;
+		return trigramCount + alphabetSize + first * alphabetSize + symbolOf(text[1]);
+	}
+
+	// Append the single symbols and the pairs of one field
+	static void addShortGrams(const std::string &field, std::vector<std::uint32_t> &grams)
+	{
+		for (size_t i = 0; i < field.size(); ++i)
+		{
+			int first = symbolOf(field[i]);
+			grams.push_back(trigramCount + first);
+			if (i + 1 < field.size())
+				grams.push_back(trigramCount + alphabetSize + first * alphabetSize + symbolOf(field[i + 1]));
+		}
+	}
+
+	// Distinct grams (trigrams, then single symbols and pairs) of a user's searchable fields, sorted
+	static std::vector<std::uint32_t> gramsOf(const std::string &id, const std::string &username, const std::string &fullName)
+	{
+		std::vector<std::uint32_t> grams;
+		grams.reserve(3 * (id.size() + username.size() + fullName.size()));
+		for (const std::string *field : {&id, &username, &fullName})
+		{
+			addTrigrams(*field, grams);
+			addShortGrams(*field, grams);
+		}
+		std::sort(grams.begin(), grams.end());
+		grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+		return grams;
+	}
+
+	// Check whether a lowercased query only uses characters the folded alphabet keeps apart
+	static bool unfolded(const std::string &needle)
+	{
+		return std::none_of(needle.begin(), needle.end(), [](char c)
+							{ return symbolOf(c) == otherSymbol; });
+	}
+
+	// Bitmap of the documents whose fields contain a one- or two-character normalized query. The
+	// gram's bitmap is exact unless a character of the query was folded; then each document is checked.
+	std::vector<std::uint64_t> shortHits(const std::string &needle) const
+	{
+		std::vector<std::uint64_t> bits = shortGrams[shortGramOf(needle) - trigramCount];
+		bits.resize((docSummary.size() + 63) / 64);
+		if (unfolded(needle))
+			return bits;
+
+		for (size_t word = 0; word < bits.size(); ++word)
+		{
+			for (std::uint64_t rest = bits[word]; rest; rest &= rest - 1)
+			{
+				int bit = __builtin_ctzll(rest);
+				if (!matches(*docSummary[word * 64 + bit], needle))
+					bits[word] &= ~(std::uint64_t(1) << bit);
+			}
+		}
+		return bits;
+	}
+
+	// Add a document to the given posting lists and bitmaps
+	void post(std::uint32_t doc, const std::vector<std::uint32_t> &grams)
+	{
+		for (std::uint32_t gram : grams)
+		{
+			if (gram >= trigramCount)
+			{
+				std::vector<std::uint64_t> &bits = shortGrams[gram - trigramCount];
+				if (bits.size() <= doc / 64)
+					bits.resize(doc / 64 + 1);
+				bits[doc / 64] |= std::uint64_t(1) << (doc % 64);
+				continue;
+			}
+			std::vector<std::uint32_t> &list = postings[gram];
+			// New documents have the highest number, so this is usually a plain append
+			if (list.empty() || list.back() < doc)
+				list.push_back(doc);
+			else
+				list.insert(std::lower_bound(list.begin(), list.end(), doc), doc);
+		}
+	}
+
+	// Remove a document from the given bitmaps, and from the given posting lists unless they are
+	// left to purgeRemoved()
+	void unpost(std::uint32_t doc, const std::vector<std::uint32_t> &grams, bool keepPostings = false)
+	{
+		for (std::uint32_t gram : grams)
+		{
+			if (gram >= trigramCount)
+			{
+				std::vector<std::uint64_t> &bits = shortGrams[gram - trigramCount];
+				if (doc / 64 < bits.size())
+					bits[doc / 64] &= ~(std::uint64_t(1) << (doc % 64));
+				continue;
+			}
+			if (keepPostings)
+				continue;
+			std::vector<std::uint32_t> &list = postings[gram];
+			auto it = std::lower_bound(list.begin(), list.end(), doc);
+			if (it != list.end() && *it == doc)
+				list.erase(it);
+		}
+	}
+
+	// Keep only the documents of candidates that also appear in list (both sorted)
+	static void intersect(std::vector<std::uint32_t> &candidates, const std::vector<std::uint32_t> &list)
+	{
+		auto out = candidates.begin();
+		auto from = list.begin();
+		for (std::uint32_t doc : candidates)
+		{
+			from = std::lower_bound(from, list.end(), doc);
+			if (from == list.end())
+				break;
+			if (*from == doc)
+				*out++ = doc;
+		}
+		candidates.erase(out, candidates.end());
+	}
+
+	// ASCII lowercase of a character (what toLower does in the default C locale)
+	static char lower(char c)
+	{
+		return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+	// Case-insensitive substring test against an already lowercased needle, without copying the haystack
+	static bool containsLower(const std::string &haystack, const std::string &needle)
+	{
+		if (needle.size() > haystack.size())
+			return false;
+
+		const size_t last = haystack.size() - needle.size();
+		for (size_t i = 0; i <= last; ++i)
+		{
+			size_t k = 0;
+			while (k < needle.size() && lower(haystack[i + k]) == needle[k])
+				++k;
+			if (k == needle.size())
+				return true;
+		}
+		return false;
+	}
+
+	// Check whether document a is listed before document b: newer first, ties by ID
+	bool listedBefore(std::uint32_t a, std::uint32_t b) const
+	{
+		if (docCreatedAt[a] != docCreatedAt[b])
+			return docCreatedAt[a] > docCreatedAt[b];
+		return docSummary[a]->id < docSummary[b]->id;
+	}
+
+	// Drop the entries of removed documents from the creation order
+	void compactOrder() const
+	{
+		if (deadAt.empty())
+			return;
+
+		size_t kept = 0;
+		for (std::uint32_t doc : order)
+		{
+			if (docSummary[doc])
+			{
+				docPosition[doc] = kept;
+				order[kept++] = doc;
+			}
+		}
+		order.resize(kept);
+		deadAt.clear();
+	}
+
+	// Merge the documents added since the last query into the creation order
+	void settleOrder() const
+	{
+		if (pendingOrder.empty())
+			return;
+
+		compactOrder(); // Dead entries cannot be compared, and the merge moves every position anyway
+		auto before = [this](std::uint32_t a, std::uint32_t b)
+		{ return listedBefore(a, b); };
+		std::sort(pendingOrder.begin(), pendingOrder.end(), before);
+		size_t middle = order.size();
+		order.insert(order.end(), pendingOrder.begin(), pendingOrder.end());
+		std::inplace_merge(order.begin(), order.begin() + middle, order.end(), before);
+		pendingOrder.clear();
+		for (size_t i = 0; i < order.size(); ++i)
+			docPosition[order[i]] = i;
+	}
+
+	// Position in order of the live entry preceded by live others: the least position with that
+	// many live entries before it, found by skipping the dead positions up to it until none are left
+	size_t livePosition(size_t live) const
+	{
+		size_t position = live;
+		size_t skipped = 0;
+		while (true)
+		{
+			size_t dead = std::upper_bound(deadAt.begin(), deadAt.end(), position) - deadAt.begin();
+			if (dead == skipped)
+				return position;
+			skipped = dead;
+			position = live + dead;
+		}
+	}
+
+	// Check whether a match set is large enough to be walked in creation order rather than selected from
+	bool isDense(size_t count) const
+	{
+		return count * 16 >= size();
+	}
+
+	// Wrap unordered matching documents (none of them listed yet) as Matches
+	Matches collect(std::vector<std::uint32_t> hits) const
+	{
+		Matches res;
+		res.total = hits.size();
+		if (!isDense(hits.size()))
+		{
+			res.unlisted = std::move(hits);
+			return res;
+		}
+
+		res.members.assign((docSummary.size() + 63) / 64, 0);
+		for (std::uint32_t doc : hits)
+			res.members[doc / 64] |= std::uint64_t(1) << (doc % 64);
+		return res;
+	}
+
+	// Wrap a bitmap of matching documents (none of them listed yet) as Matches
+	Matches collectMembers(std::vector<std::uint64_t> members) const
+	{
+		size_t total = 0;
+		for (std::uint64_t word : members)
+			total += __builtin_popcountll(word);
+		if (!isDense(total))
+		{
+			std::vector<std::uint32_t> hits;
+			hits.reserve(total);
+			for (size_t word = 0; word < members.size(); ++word)
+			{
+				for (std::uint64_t bits = members[word]; bits; bits &= bits - 1)
+					hits.push_back(static_cast<std::uint32_t>(word * 64 + __builtin_ctzll(bits)));
+			}
+			return collect(std::move(hits));
+		}
+
+		Matches res;
+		res.total = total;
+		res.members = std::move(members);
+		return res;
+	}
+
+	// Put at least the first count matches (or all of them) in listing order.
+	// Few matches: the next ones are picked with a partial selection over the unlisted ones and only
+	// those are sorted; once a quarter or more of the unlisted matches are needed, all are sorted.
+	// Many matches: the creation order is walked on until enough members have been passed.
+	void extendListing(Matches &matches, size_t count) const
+	{
+		count = std::min(count, matches.total);
+		if (matches.listed.size() >= count)
+			return;
+
+		if (!matches.members.empty())
+		{
+			while (matches.listed.size() < count && matches.walked < order.size())
+			{
+				std::uint32_t doc = order[matches.walked++];
+				if (matches.members[doc / 64] & (std::uint64_t(1) << (doc % 64)))
+					matches.listed.push_back(doc);
+			}
+			return;
+		}
+
+		auto before = [this](std::uint32_t a, std::uint32_t b)
+		{ return listedBefore(a, b); };
+		std::vector<std::uint32_t> &rest = matches.unlisted;
+		size_t need = std::min(count - matches.listed.size(), rest.size());
+		if (need * 4 >= rest.size())
+		{
+			std::sort(rest.begin(), rest.end(), before);
+			matches.listed.insert(matches.listed.end(), rest.begin(), rest.end());
+			rest.clear();
+			return;
+		}
+
+		std::nth_element(rest.begin(), rest.begin() + need, rest.end(), before);
+		std::sort(rest.begin(), rest.begin() + need, before);
+		matches.listed.insert(matches.listed.end(), rest.begin(), rest.begin() + need);
+		rest.erase(rest.begin(), rest.begin() + need);
+	}
+
+	// Documents whose fields contain a normalized query of three or more characters, in no particular order
+	std::vector<std::uint32_t> hitsFor(const std::string &needle) const
+	{
+		std::vector<std::uint32_t> hits;
+		// Posting lists of the query's trigrams, shortest first
+		std::vector<std::uint32_t> grams;
+		addTrigrams(needle, grams);
+		std::sort(grams.begin(), grams.end());
+		grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+		std::vector<const std::vector<std::uint32_t> *> lists;
+		for (std::uint32_t gram : grams)
+		{
+			if (postings[gram].empty())
+				return hits; // Some trigram occurs nowhere, so nothing can match
+			lists.push_back(&postings[gram]);
+		}
+		std::sort(lists.begin(), lists.end(), [](const std::vector<std::uint32_t> *a, const std::vector<std::uint32_t> *b)
+				  { return a->size() < b->size(); });
+
+		std::vector<std::uint32_t> candidates = *lists.front();
+		for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i)
+		{
+			intersect(candidates, *lists[i]);
+		}
+
+		// A three-character query without folded characters is its own trigram: every candidate matches.
+		// Otherwise sharing every trigram does not imply containing the query, so confirm each candidate.
+		// Either way removed documents still in the posting lists are skipped.
+		bool exact = needle.size() == 3 && unfolded(needle);
+		hits.reserve(candidates.size());
+		for (std::uint32_t doc : candidates)
+		{
+			if (docSummary[doc] && (exact || matches(*docSummary[doc], needle)))
+				hits.push_back(doc);
+		}
+		return hits;
+	}
+
+	// Summaries of a slice of documents listed in order
+	std::vector<const UserSummary *> slice(const std::vector<std::uint32_t> &docs, size_t offset, size_t limit) const
+	{
+		std::vector<const UserSummary *> res;
+		if (offset >= docs.size())
+			return res;
+
+		size_t end = offset + std::min(limit, docs.size() - offset);
+		res.reserve(end - offset);
+		for (size_t i = offset; i < end; ++i)
+		{
+			if (docSummary[docs[i]])
+				res.push_back(docSummary[docs[i]]);
+		}
+		return res;
+	}
+
+public:
+	// Normalize a query the way search() does: trimmed and lowercased
+	static std::string normalizeQuery(const std::string &query)
+	{
+		return toLower(trim(query));
+	}
+
+	// Check whether a user's full name, ID or username contains a normalized query
+	static bool matches(const UserSummary &summary, const std::string &needle)
+	{
+		return containsLower(summary.fullName, needle) || containsLower(summary.id, needle) || containsLower(summary.username, needle);
+	}
+
+	SearchIndex() : postings(trigramCount), shortGrams(shortGramCount) {}
+
+	// Index a new user. The summary must stay at the same address until the user is removed.
+	// A document freed by a removal is reused, so the tables do not grow with every re-add.
+	void add(const UserSummary &summary)
+	{
+		std::uint32_t doc;
+		if (!freeDocs.empty())
+		{
+			doc = freeDocs.back();
+			freeDocs.pop_back();
+			docSummary[doc] = &summary;
+			docCreatedAt[doc] = summary.createdAt;
+			docPosition[doc] = unplaced;
+		}
+		else
+		{
+			doc = static_cast<std::uint32_t>(docSummary.size());
+			docSummary.push_back(&summary);
+			docCreatedAt.push_back(summary.createdAt);
+			docPosition.push_back(unplaced);
+		}
+		pendingOrder.push_back(doc);
+		docOf.emplace(summary.id, doc);
+		post(doc, gramsOf(summary.id, summary.username, summary.fullName));
+	}
+
+	// Re-index a user whose username or full name changed; only grams that differ are touched.
+	// The creation time must be unchanged (remove and add the user again otherwise).
+	void update(const UserSummary &summary, const std::string &oldUsername, const std::string &oldFullName)
+	{
+		auto it = docOf.find(summary.id);
+		if (it == docOf.end())
+		{
+			add(summary);
+			return;
+		}
+
+		std::uint32_t doc = it->second;
+		std::vector<std::uint32_t> before = gramsOf(summary.id, oldUsername, oldFullName);
+		std::vector<std::uint32_t> after = gramsOf(summary.id, summary.username, summary.fullName);
+		std::vector<std::uint32_t> removed, added;
+		std::set_difference(before.begin(), before.end(), after.begin(), after.end(), std::back_inserter(removed));
+		std::set_difference(after.begin(), after.end(), before.begin(), before.end(), std::back_inserter(added));
+		unpost(doc, removed);
+		post(doc, added);
+	}
+
+	// Drop every removed document from the posting lists and the creation order, so that add() can
+	// reuse their numbers
+	void purgeRemoved()
+	{
+		auto removed = [this](std::uint32_t doc)
+		{ return !docSummary[doc]; };
+		std::sort(staleGrams.begin(), staleGrams.end());
+		staleGrams.erase(std::unique(staleGrams.begin(), staleGrams.end()), staleGrams.end());
+		for (std::uint32_t gram : staleGrams)
+		{
+			std::vector<std::uint32_t> &list = postings[gram];
+			list.erase(std::remove_if(list.begin(), list.end(), removed), list.end());
+		}
+		staleGrams.clear();
+		compactOrder();
+		freeDocs.insert(freeDocs.end(), retiredDocs.begin(), retiredDocs.end());
+		retiredDocs.clear();
+	}
+
+	// Stop returning a user from searches (call before the summary is destroyed). The user's entries
+	// in the posting lists and the creation order are only skipped from then on, so a removal does
+	// not shift those whole lists; they are purged in one pass once the removed users reach a
+	// sixty-fourth of the remaining ones.
+	void remove(const UserSummary &summary)
+	{
+		auto it = docOf.find(summary.id);
+		if (it == docOf.end())
+			return;
+
+		std::uint32_t doc = it->second;
+		std::vector<std::uint32_t> grams = gramsOf(summary.id, summary.username, summary.fullName);
+		unpost(doc, grams, true);
+		for (std::uint32_t gram : grams)
+		{
+			if (gram < trigramCount)
+				staleGrams.push_back(gram);
+		}
+		docSummary[doc] = nullptr;
+		docOf.erase(it);
+		size_t position = docPosition[doc];
+		if (position == unplaced)
+			pendingOrder.erase(std::find(pendingOrder.begin(), pendingOrder.end(), doc));
+		else
+			deadAt.insert(std::upper_bound(deadAt.begin(), deadAt.end(), position), position);
+
+		retiredDocs.push_back(doc);
+		if (retiredDocs.size() * 64 >= docOf.size())
+			purgeRemoved();
+	}
+
+	// Reserve room for a bulk load of users
+	void reserve(size_t count)
+	{
+		docOf.reserve(count);
+		docSummary.reserve(count);
+		docCreatedAt.reserve(count);
+		docPosition.reserve(count);
+		order.reserve(count);
+		pendingOrder.reserve(count);
+	}
+
+	// Bytes held by the trigram posting lists
+	size_t postingBytes() const
+	{
+		size_t bytes = 0;
+		for (const std::vector<std::uint32_t> &list : postings)
+			bytes += list.capacity() * sizeof(std::uint32_t);
+		return bytes;
+	}
+
+	// Bytes held by the bitmaps of single symbols and symbol pairs
+	size_t bitmapBytes() const
+	{
+		size_t bytes = 0;
+		for (const std::vector<std::uint64_t> &bits : shortGrams)
+			bytes += bits.capacity() * sizeof(std::uint64_t);
+		return bytes;
+	}
+
+	// Number of indexed users
+	size_t size() const
+	{
+		return order.size() - deadAt.size() + pendingOrder.size();
+	}
+
+	// Users whose ID, username or full name contains query (case-insensitive, ignoring surrounding
+	// whitespace); every user for an empty query. None of them are put in order until a page is read.
+	// Not safe to call concurrently with itself or the other query functions: they may settle the
+	// creation order.
+	Matches match(const std::string &query) const
+	{
+		std::string needle = normalizeQuery(query);
+		settleOrder();
+		if (needle.empty())
+		{
+			compactOrder(); // The whole order is copied anyway
+			return collect(order);
+		}
+		if (needle.size() < 3)
+			return collectMembers(shortHits(needle));
+		return collect(hitsFor(needle));
+	}
+
+	// Narrow the matches of a query down to a query extending it. Every match of the longer query
+	// is among the earlier matches, so only those are checked; the listed ones stay listed.
+	Matches refine(const Matches &previous, const std::string &query) const
+	{
+		std::string needle = normalizeQuery(query);
+		auto keep = [this, &needle](std::uint32_t doc)
+		{ return docSummary[doc] && matches(*docSummary[doc], needle); };
+
+		std::vector<std::uint32_t> listed, rest;
+		for (std::uint32_t doc : previous.listed)
+		{
+			if (keep(doc))
+				listed.push_back(doc);
+		}
+		if (previous.members.empty())
+		{
+			for (std::uint32_t doc : previous.unlisted)
+			{
+				if (keep(doc))
+					rest.push_back(doc);
+			}
+		}
+		else
+		{
+			// Members already walked past are the listed ones; the rest lie further along the order
+			for (size_t i = previous.walked; i < order.size(); ++i)
+			{
+				std::uint32_t doc = order[i];
+				if ((previous.members[doc / 64] & (std::uint64_t(1) << (doc % 64))) && keep(doc))
+					rest.push_back(doc);
+			}
+		}
+
+		Matches res = collect(std::move(rest));
+		res.total += listed.size();
+		res.listed = std::move(listed);
+		if (!res.members.empty())
+			res.walked = previous.walked;
+		return res;
+	}
+
+	// Summaries of up to limit matches starting at offset, ordering only as many matches as that needs
+	std::vector<const UserSummary *> page(Matches &matches, size_t offset, size_t limit) const
+	{
+		extendListing(matches, offset + std::min(limit, matches.total));
+		return slice(matches.listed, offset, limit);
+	}
+
+	// Summaries of up to limit users starting at offset, newest first, without collecting any matches
+	std::vector<const UserSummary *> page(size_t offset, size_t limit) const
+	{
+		settleOrder();
+		if (deadAt.empty())
+			return slice(order, offset, limit);
+
+		std::vector<const UserSummary *> res;
+		for (size_t i = livePosition(offset); i < order.size() && res.size() < limit; ++i)
+		{
+			if (docSummary[order[i]])
+				res.push_back(docSummary[order[i]]);
+		}
+		return res;
+	}
+
+	// Summaries of every user matching a query (see match()), newest first
+	std::vector<const UserSummary *> search(const std::string &query) const
+	{
+		Matches matches = match(query);
+		return page(matches, 0, matches.total);
+	}
+};
+
+#endif // SEARCH_INDEX_H
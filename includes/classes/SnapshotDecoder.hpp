@@ -0,0 +1,189 @@
+#ifndef SNAPSHOT_DECODER_H
+#define SNAPSHOT_DECODER_H
+
+// Standard library headers
+#include <string>	  // Provides std::string for the snapshot's header fields
+#include <vector>	  // Holds the decoded records
+#include <memory>	  // Hands the decoded admins and patients over as shared pointers
+#include <filesystem> // Names the snapshot file in error messages
+#include <cstdint>	  // Provides the sequence number the snapshot covers
+
+#include "json.hpp"			 // SAX interface of the JSON parser
+#include "RecordDecoder.hpp" // Decodes each record of the snapshot
+
+using json = nlohmann::json;
+
+// The SnapshotDecoder class reads a checkpoint snapshot as a stream of SAX events. Each element of the
+// admins and patients arrays is handed to a RecordDecoder, which fills an Admin, a Patient or (when
+// summaries are wanted) a UserSummary as the record is read, so the snapshot never exists as a json
+// document. The header fields are kept for the caller to check once the whole snapshot is read; the
+// snapshot is written with its keys sorted, so kind arrives before the patients and a summary
+// snapshot is abandoned there when full patients are wanted.
+class SnapshotDecoder
+{
+public:
+	std::vector<std::shared_ptr<Admin>> admins;		// Every admin
+	std::vector<std::shared_ptr<Patient>> patients; // Every patient, when summaries are not wanted
+	std::vector<UserSummary> summaries;				// Every patient's summary, when they are wanted
+	std::string kind = "full";						// "full" or "summary" (patients as summaries only)
+	std::string storage;							// Storage mode that wrote the snapshot
+	std::uint64_t seq = 0;							// Last change log record the snapshot covers
+	bool hasCounts = false;							// The snapshot carries the record counters
+
+private:
+	// Top-level keys of a snapshot
+	enum Section
+	{
+		Other,
+		Admins,
+		Patients,
+		Kind,
+		Storage,
+		Seq,
+		Counts
+	};
+
+	std::filesystem::path source; // Snapshot file, for error messages
+	bool wantSummaries;			  // Decode patients as summaries
+	int depth = 0;				  // Nesting outside the record being decoded (1 = snapshot object)
+	Section section = Other;	  // Top-level key whose value is being read
+	RecordDecoder record;		  // Decoder of the current record
+	bool inRecord = false;		  // Events belong to the current record
+
+	// Start decoding an element of the admins or patients array
+	void startRecord()
+	{
+		record = RecordDecoder();
+		record.source = &source;
+		if (section == Admins)
+		{
+			admins.push_back(std::make_shared<Admin>());
+			record.start(*admins.back());
+		}
+		else if (wantSummaries)
+		{
+			summaries.emplace_back();
+			record.start(summaries.back());
+		}
+		else
+		{
+			patients.push_back(std::make_shared<Patient>());
+			record.start(*patients.back());
+		}
+		inRecord = true;
+	}
+
+	// Store a top-level number (only seq is one)
+	bool setNumber(std::uint64_t value)
+	{
+		if (depth == 1 && section == Seq)
+			seq = value;
+		return true;
+	}
+
+public:
+	SnapshotDecoder(const std::filesystem::path &source, bool wantSummaries) : source(source), wantSummaries(wantSummaries) {}
+
+	// SAX events (see nlohmann::json_sax); events inside a record go to its decoder
+
+	bool null() { return inRecord ? record.null() : true; }
+	bool boolean(bool value) { return inRecord ? record.boolean(value) : true; }
+	bool binary(json::binary_t &value) { return inRecord ? record.binary(value) : true; }
+	bool number_integer(json::number_integer_t value) { return inRecord ? record.number_integer(value) : setNumber(static_cast<std::uint64_t>(value)); }
+	bool number_unsigned(json::number_unsigned_t value) { return inRecord ? record.number_unsigned(value) : setNumber(value); }
+	bool number_float(json::number_float_t value, const json::string_t &text) { return inRecord ? record.number_float(value, text) : true; }
+
+	bool string(json::string_t &value)
+	{
+		if (inRecord)
+			return record.string(value);
+		if (depth == 1 && section == Kind)
+		{
+			kind = value;
+			return wantSummaries || kind != "summary"; // Summaries cannot stand in for full patients
+		}
+		if (depth == 1 && section == Storage)
+			storage = value;
+		return true;
+	}
+
+	bool key(json::string_t &name)
+	{
+		if (inRecord)
+			return record.key(name);
+		if (depth == 1)
+		{
+			if (name == "admins")
+				section = Admins;
+			else if (name == "patients")
+				section = Patients;
+			else if (name == "kind")
+				section = Kind;
+			else if (name == "storage")
+				section = Storage;
+			else if (name == "seq")
+				section = Seq;
+			else if (name == "counts")
+				section = Counts;
+			else
+				section = Other;
+		}
+		return true;
+	}
+
+	bool start_object(std::size_t size)
+	{
+		if (!inRecord && depth == 2 && (section == Admins || section == Patients))
+			startRecord();
+		if (inRecord)
+			return record.start_object(size);
+
+		++depth;
+		if (depth == 2 && section == Counts)
+			hasCounts = true;
+		return true;
+	}
+
+	bool end_object()
+	{
+		if (!inRecord)
+		{
+			--depth;
+			return true;
+		}
+
+		record.end_object();
+		if (record.depth == 0)
+		{
+			record.finish();
+			inRecord = false;
+		}
+		return true;
+	}
+
+	bool start_array(std::size_t size)
+	{
+		if (inRecord)
+			return record.start_array(size);
+		++depth;
+		return true;
+	}
+
+	bool end_array()
+	{
+		if (inRecord)
+			return record.end_array();
+		--depth;
+		return true;
+	}
+
+	// A snapshot that is not valid JSON is unusable, like a missing one: parsing stops and read() fails
+	// (a record that does not decode throws instead; UserManager::readSnapshot treats both alike)
+	template <typename Exception>
+	bool parse_error(std::size_t, const std::string &, const Exception &)
+	{
+		return false;
+	}
+};
+
+#endif // SNAPSHOT_DECODER_H
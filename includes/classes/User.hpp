@@ -6,10 +6,12 @@
 #include <vector>     // Allows storage of multiple items in a dynamic array
 #include <fstream>    // Enables reading and writing user data to files
 #include <filesystem> // Supports file and directory operations
+#include <map>        // Holds the admission counts of a summary by department
 
 // Project-specific headers
 #include "utils.hpp" // Provides utility functions such as UUID generation and timestamp formatting
 #include "json.hpp"  // Enables JSON serialization/deserialization
+#include "admissions.hpp" // Departments that admissions are counted by
 
 // Using the nlohmann JSON library
 using json = nlohmann::json;
@@ -31,6 +33,8 @@ class User
 protected:
     std::string id; // Unique identifier for the user
 
+    friend class RecordDecoder; // Decodes stored records directly into the user's fields
+
 public:
     // Common user attributes
     std::chrono::system_clock::time_point createdAt; // Timestamp when the user was created
@@ -115,4 +119,73 @@ public:
     Role getRole() const { return role; }
 };
 
+// Lightweight view of a user holding only the fields needed for listings and lookups
+struct UserSummary
+{
+    std::string id;                                  // Unique identifier of the user
+    std::string username;                            // Username used for login
+    std::string fullName;                            // Full name shown in listings
+    Role role = Role::User;                          // Role of the user
+    std::chrono::system_clock::time_point createdAt; // Account creation timestamp
+    std::map<Admissions::Department, int> admissionCounts; // Number of admissions per department (patients only)
+
+    UserSummary() = default;
+
+    // Build a summary from a loaded user
+    explicit UserSummary(const User &user)
+        : id(user.getId()),
+          username(user.username),
+          fullName(user.fullName),
+          role(user.role),
+          createdAt(user.createdAt)
+    {
+    }
+
+    // Build a summary from a serialized summary or full record; of the admissions only the counts are kept
+    static UserSummary fromJson(const json &j)
+    {
+        UserSummary summary;
+        summary.id = j.at("id").get<std::string>();
+        summary.username = j.at("username").get<std::string>();
+        summary.fullName = j.at("fullName").get<std::string>();
+        summary.role = User::getRoleToEnum(j.at("role").get<std::string>());
+        summary.createdAt = parseTimestamp(j.at("createdAt").get<std::string>());
+        if (j.contains("admissionCounts"))
+        {
+            for (const auto &[deptStr, count] : j.at("admissionCounts").items())
+            {
+                summary.admissionCounts[Admissions::stringToDepartment(deptStr)] = count.get<int>();
+            }
+        }
+        else if (j.contains("admissions"))
+        {
+            for (const auto &[deptStr, dates] : j.at("admissions").items())
+            {
+                summary.admissionCounts[Admissions::stringToDepartment(deptStr)] = static_cast<int>(dates.size());
+            }
+        }
+        return summary;
+    }
+
+    // Serialize the summary using the same keys as a full record, plus the admission counts
+    json toJson() const
+    {
+        json j = {
+            {"id", id},
+            {"role", User::getRoleToString(role)},
+            {"username", username},
+            {"fullName", fullName},
+            {"createdAt", formatTimestamp(createdAt)}};
+        if (!admissionCounts.empty())
+        {
+            j["admissionCounts"] = json::object();
+            for (const auto &[dept, count] : admissionCounts)
+            {
+                j["admissionCounts"][Admissions::departmentToString(dept)] = count;
+            }
+        }
+        return j;
+    }
+};
+
 #endif // USER_H
@@ -0,0 +1,161 @@
+#ifndef USER_CACHE_H
+#define USER_CACHE_H
+
+// Standard library headers
+#include <string>		 // User IDs are the cache keys
+#include <list>			 // Keeps the cached users in least-recently-used order
+#include <unordered_map> // Maps user IDs to their place in the order
+#include <vector>		 // Returns the users chosen for eviction
+#include <functional>	 // Lets the caller decide which users are pinned
+#include <cstdint>		 // Provides the 64-bit statistics counters
+
+#include "User.hpp"	   // Base fields of every cached user
+#include "Patient.hpp" // Patient fields and admissions counted into the byte estimate
+
+// The UserCache class bounds how many full records stay in memory when patients are loaded on demand.
+// It tracks the cached users in least-recently-used order with an estimate of their size, and picks
+// the least recently used ones to drop once a count or byte budget is exceeded. The caller decides
+// which users are pinned (and so never picked), and removes the picked users from its own storage.
+class UserCache
+{
+public:
+	// Counters for tuning the budget
+	struct Stats
+	{
+		std::uint64_t hits = 0;		 // Lookups answered from memory
+		std::uint64_t misses = 0;	 // Lookups that had to read the record file
+		std::uint64_t evictions = 0; // Users dropped to stay within the budget
+		size_t users = 0;			 // Users currently cached
+		size_t bytes = 0;			 // Estimated size of the cached users
+	};
+
+private:
+	struct Entry
+	{
+		std::list<std::string>::iterator position; // Place in recency
+		size_t bytes;							   // Estimated size of the user
+	};
+
+	size_t maxUsers; // Most users kept (0 = no limit)
+	size_t maxBytes; // Most estimated bytes kept (0 = no limit)
+	std::list<std::string> recency; // Cached user IDs, most recently used first
+	std::unordered_map<std::string, Entry> entries;
+	Stats stats;
+
+	// Heap bytes held by a string beyond the object itself
+	static size_t heapBytes(const std::string &value)
+	{
+		return value.capacity() > 15 ? value.capacity() + 1 : 0;
+	}
+
+	// Check whether the cache holds more than its budget allows
+	bool overBudget() const
+	{
+		return (maxUsers > 0 && stats.users > maxUsers) || (maxBytes > 0 && stats.bytes > maxBytes);
+	}
+
+public:
+	UserCache(size_t maxUsers = 0, size_t maxBytes = 0) : maxUsers(maxUsers), maxBytes(maxBytes) {}
+
+	// Check whether a budget is set at all
+	bool isBounded() const
+	{
+		return maxUsers > 0 || maxBytes > 0;
+	}
+
+	// Rough number of bytes a loaded user occupies, including its strings and admissions
+	static size_t estimateBytes(const User &user)
+	{
+		size_t bytes = sizeof(User) + heapBytes(user.getId()) + heapBytes(user.username) + heapBytes(user.password) +
+					   heapBytes(user.fullName) + heapBytes(user.email) + heapBytes(user.contactNumber);
+
+		const Patient *patient = dynamic_cast<const Patient *>(&user);
+		if (!patient)
+			return bytes;
+
+		bytes += sizeof(Patient) - sizeof(User) + heapBytes(patient->religion) + heapBytes(patient->nationality) +
+				 heapBytes(patient->identityCardNumber) + heapBytes(patient->maritalStatus) + heapBytes(patient->gender) +
+				 heapBytes(patient->race) + heapBytes(patient->emergencyContactNumber) + heapBytes(patient->emergencyContactName) +
+				 heapBytes(patient->address) + heapBytes(patient->height) + heapBytes(patient->weight) +
+				 patient->admissions.memoryBytes();
+		return bytes;
+	}
+
+	// Count a lookup answered from memory and mark the user as most recently used
+	void hit(const std::string &userId)
+	{
+		auto it = entries.find(userId);
+		if (it == entries.end())
+			return;
+		++stats.hits;
+		recency.splice(recency.begin(), recency, it->second.position);
+	}
+
+	// Count a lookup that had to read the record file
+	void miss()
+	{
+		++stats.misses;
+	}
+
+	// Add a user, or refresh its size after a change, as the most recently used
+	void insert(const User &user)
+	{
+		size_t bytes = estimateBytes(user);
+		auto it = entries.find(user.getId());
+		if (it == entries.end())
+		{
+			recency.push_front(user.getId());
+			entries.emplace(user.getId(), Entry{recency.begin(), bytes});
+			++stats.users;
+			stats.bytes += bytes;
+			return;
+		}
+
+		stats.bytes = stats.bytes - it->second.bytes + bytes;
+		it->second.bytes = bytes;
+		recency.splice(recency.begin(), recency, it->second.position);
+	}
+
+	// Forget a user (deleted, or dropped by the caller)
+	void erase(const std::string &userId)
+	{
+		auto it = entries.find(userId);
+		if (it == entries.end())
+			return;
+		stats.users--;
+		stats.bytes -= it->second.bytes;
+		recency.erase(it->second.position);
+		entries.erase(it);
+	}
+
+	// Pick the least recently used users to drop until the budget holds again, skipping pinned ones.
+	// The picked users are already forgotten by the cache; the caller removes them from memory.
+	std::vector<std::string> evict(const std::function<bool(const std::string &)> &isPinned)
+	{
+		std::vector<std::string> evicted;
+		auto next = recency.end(); // The candidate is the entry before next; erasing it keeps next valid
+		while (overBudget() && next != recency.begin())
+		{
+			auto candidate = std::prev(next);
+			if (isPinned(*candidate))
+			{
+				next = candidate;
+				continue;
+			}
+
+			std::string userId = *candidate;
+			erase(userId);
+			++stats.evictions;
+			evicted.push_back(userId);
+		}
+		return evicted;
+	}
+
+	// Current counters
+	Stats getStats() const
+	{
+		return stats;
+	}
+};
+
+#endif // USER_CACHE_H
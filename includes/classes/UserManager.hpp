@@ -1,630 +1,1564 @@
-#ifndef USER_MANAGER_H
-#define USER_MANAGER_H
-
-#include <unordered_map> // Used for storing and managing user data efficiently
-#include <memory>		 // Enables the use of smart pointers (std::shared_ptr, std::unique_ptr)
-#include <functional>	 // Provides std::function for storing and invoking update functions
-
-// User-related class headers
-#include "User.hpp"	   // Base class for different user roles (Admin, Patient)
-#include "Admin.hpp"   // Derived class representing Admin users
-#include "Patient.hpp" // Derived class representing Patient users
-
-// Utility functions
-#include "utils.hpp" // Helper functions (e.g., string manipulation, validation)
-
-// Admissions management
-#include "admissions.hpp" // Manages patient admissions and related operations
-
-
-// The UserManager class is responsible for managing the CRUD operations of user-related objects
-class UserManager
-{
-private:
-	// In-memory storage of users as shared pointers for fast lookups
-	std::unordered_map<std::string, std::shared_ptr<User>> userMap;
-	std::shared_ptr<User> currentUser; // Currently logged-in user
-
-	// Singleton constructor: private to prevent direct instantiation
-	UserManager()
-	{
-		populateUserMap(); // Load all users into memory
-	}
-	~UserManager() = default;
-	UserManager(const UserManager &) = delete;
-	UserManager &operator=(const UserManager &) = delete;
-
-	// Load a user from a file given their user ID and role
-	std::shared_ptr<User> getUserFromFile(const std::string &userId, const std::string &role)
-	{
-		std::shared_ptr<User> user = nullptr;
-		std::string filePath = "db/" + role + "/" + userId + ".json";
-
-		// Check if the file exists before attempting to read
-		if (std::filesystem::exists(filePath))
-		{
-			std::ifstream file(filePath);
-			if (file.is_open())
-			{
-				nlohmann::json j;
-				file >> j;
-				file.close();
-
-				// Deserialize the JSON data into the appropriate user object
-				if (role == "admin")
-				{
-					user = std::make_shared<Admin>();
-					from_json(j, *std::dynamic_pointer_cast<Admin>(user));
-				}
-				else if (role == "patient")
-				{
-					user = std::make_shared<Patient>();
-					from_json(j, *std::dynamic_pointer_cast<Patient>(user));
-				}
-				userMap[userId] = user; // Cache the user in memory
-			}
-		}
-		return user;
-	}
-
-	// Delete a user file based on their ID
-	bool deleteUserFromFile(const std::string &userId)
-	{
-		std::vector<Role> roles = {Role::Admin, Role::Patient, Role::User};
-		for (const auto &role : roles)
-		{
-			std::string roleStr = User::getRoleToString(role);
-			std::string filePath = "db/" + roleStr + "/" + userId + ".json";
-
-			if (fs::exists(filePath))
-			{
-				try
-				{
-					fs::remove(filePath);
-					return true;
-				}
-				catch (const std::exception &e)
-				{
-					std::cerr << "Error deleting file " << filePath << ": " << e.what() << std::endl;
-					return false;
-				}
-			}
-		}
-		return false;
-	}
-
-	// Load all user records from the database into memory
-	void populateUserMap()
-	{
-		std::vector<Role> roles = {Role::Admin, Role::Patient, Role::User};
-		for (const auto &role : roles)
-		{
-			std::string roleStr = User::getRoleToString(role);
-			std::string filePath = "db/" + roleStr + "/";
-
-			if (!std::filesystem::exists(filePath))
-			{
-				std::cerr << "Directory not found: " << filePath << std::endl;
-				continue;
-			}
-
-			for (const auto &entry : std::filesystem::directory_iterator(filePath))
-			{
-				if (entry.path().extension() == ".json")
-				{
-					std::ifstream file(entry.path());
-					if (file.is_open())
-					{
-						nlohmann::json j;
-						file >> j;
-						file.close();
-						std::shared_ptr<User> user = nullptr;
-
-						if (roleStr == "admin")
-						{
-							user = std::make_shared<Admin>();
-							from_json(j, *std::dynamic_pointer_cast<Admin>(user));
-						}
-						else if (roleStr == "patient")
-						{
-							user = std::make_shared<Patient>();
-							from_json(j, *std::dynamic_pointer_cast<Patient>(user));
-						}
-
-						userMap[j["id"]] = user;
-					}
-				}
-			}
-		}
-	}
-
-public:
-	// Get the singleton instance of UserManager
-	static UserManager &getInstance()
-	{
-		static UserManager instance;
-		return instance;
-	}
-
-	// Create a new patient record and store it in the user map and file system
-	void createPatient(const std::string &username, const std::string &password, int age, const std::string &fullName,
-					   const std::string &religion, const std::string &nationality,
-					   const std::string &identityCardNumber, const std::string &maritalStatus, const std::string &gender,
-					   const std::string &race, const std::string &email, const std::string &contactNumber,
-					   const std::string &emergencyContactNumber, const std::string &emergencyContactName, const std::string &address,
-					   double bmi, const std::string &height, const std::string &weight, Admissions::Department dept)
-	{
-		// Create a new Patient object
-		std::shared_ptr<Patient> newPatient = std::make_shared<Patient>(
-			username, password, age, fullName, religion, nationality, identityCardNumber,
-			maritalStatus, gender, race, email, contactNumber, emergencyContactNumber, emergencyContactName,
-			address, bmi, height, weight, dept);
-
-		// Try inserting the patient into the user map
-		auto result = userMap.insert({newPatient->getId(), newPatient});
-		if (!result.second)
-		{
-			// User already exists, print an error message
-			std::cout << "Patient with ID " << newPatient->getId() << " already exists.\n";
-			std::cout << "Patient with username " << newPatient->getUsername() << " already exists.\n";
-			return;
-		}
-
-		// Save patient details to a file for persistence
-		newPatient->saveToFile();
-	}
-
-	// Create a new admin record and store it in the user map and file system
-	void createAdmin(const std::string &username, const std::string &password, const std::string &fullName, const std::string &email, const std::string &contactNumber)
-	{
-		// Create a new Admin object
-		std::shared_ptr<Admin> newAdmin = std::make_shared<Admin>(username, password, fullName, email, contactNumber);
-
-		// Try inserting the admin into the user map
-		auto result = userMap.insert({newAdmin->getId(), newAdmin});
-		if (!result.second)
-		{
-			// User already exists, print an error message
-			std::cout << "Admin with ID " << newAdmin->getId() << " already exists.\n";
-			std::cout << "Admin with username " << newAdmin->getUsername() << " already exists.\n";
-			return;
-		}
-
-		// Save admin details to a file for persistence
-		newAdmin->saveToFile();
-	}
-
-	// Retrieve a user record by ID (either from memory or file system)
-	std::shared_ptr<User> getUserById(const std::string &userId)
-	{
-		// Check if the user is already stored in memory
-		auto it = userMap.find(userId);
-		if (it != userMap.end())
-		{
-			return it->second;
-		}
-
-		// If not found in memory, check in the file system for admin users
-		std::shared_ptr<User> user = getUserFromFile(userId, "admin");
-		if (user)
-		{
-			userMap[userId] = user;
-			return user;
-		}
-
-		// Check in the file system for patient users
-		user = getUserFromFile(userId, "patient");
-		if (user)
-		{
-			userMap[userId] = user;
-			return user;
-		}
-
-		// If user is not found, return nullptr
-		return nullptr;
-	}
-
-	// Retrieve a user record by username (searches both memory and file system)
-	std::shared_ptr<User> getUserByUsername(const std::string &username)
-	{
-		// Normalize the input username by trimming and converting to lowercase
-		std::string trimmedUsername = toLower(trim(username));
-
-		// Search in-memory storage first
-		for (const auto &pair : userMap)
-		{
-			if (toLower(trim(pair.second->getUsername())) == trimmedUsername)
-			{
-				return pair.second;
-			}
-		}
-
-		// If not found in memory, check in the file system across all roles
-		std::vector<Role> roles = {Role::Admin, Role::Patient, Role::User};
-		for (const auto &role : roles)
-		{
-			std::string roleStr = User::getRoleToString(role);
-			std::string filePath = "db/" + roleStr + "/";
-
-			try
-			{
-				// Iterate over user files in the role directory
-				for (const auto &entry : std::filesystem::directory_iterator(filePath))
-				{
-					if (entry.path().extension() == ".json")
-					{
-						// Read the user file
-						std::ifstream file(entry.path());
-						if (file.is_open())
-						{
-							nlohmann::json j;
-							file >> j;
-							file.close();
-
-							// If username matches, return the user object
-							if (j.contains("username") && toLower(trim(j["username"].get<std::string>())) == trimmedUsername)
-							{
-								auto user = getUserFromFile(j["id"], roleStr);
-								if (user)
-								{
-									return user;
-								}
-							}
-						}
-					}
-				}
-			}
-			catch (const std::exception &e)
-			{
-				return nullptr;
-			}
-		}
-
-		// If user is not found, return nullptr
-		return nullptr;
-	}
-
-	// Retrieve a user record by full name (searches both memory and file system)
-	std::shared_ptr<User> getUserByName(const std::string &fullName)
-	{
-		// Normalize the input name by trimming and converting to lowercase
-		std::string trimmedName = toLower(trim(fullName));
-
-		// Search in-memory storage first
-		for (const auto &pair : userMap)
-		{
-			if (toLower(trim(pair.second->getFullName())) == trimmedName)
-			{
-				return pair.second;
-			}
-		}
-
-		// If not found in memory, check in the file system across all roles
-		std::vector<Role> roles = {Role::Admin, Role::Patient, Role::User};
-		for (const auto &role : roles)
-		{
-			std::string roleStr = User::getRoleToString(role);
-			std::string filePath = "db/" + roleStr + "/";
-
-			try
-			{
-				// Iterate over user files in the role directory
-				for (const auto &entry : std::filesystem::directory_iterator(filePath))
-				{
-					if (entry.path().extension() == ".json")
-					{
-						// Read the user file
-						std::ifstream file(entry.path());
-						if (file.is_open())
-						{
-							nlohmann::json j;
-							file >> j;
-							file.close();
-
-							// If full name matches, return the user object
-							if (j.contains("fullName") && toLower(trim(j["fullName"])) == trimmedName)
-							{
-								auto user = getUserFromFile(j["id"], roleStr);
-								if (user)
-								{
-									return user;
-								}
-							}
-						}
-					}
-				}
-			}
-			catch (const std::exception &e)
-			{
-				return nullptr;
-			}
-		}
-
-		// If user is not found, return nullptr
-		return nullptr;
-	}
-
-	// Delete a user record by ID (removes from memory and file system)
-	void deleteUserById(const std::string &userId)
-	{
-		// Check if the user exists in memory
-		auto it = userMap.find(userId);
-		if (it != userMap.end())
-		{
-			// Remove user from memory storage
-			userMap.erase(it);
-		}
-
-		// Attempt to delete user from file system
-		bool isDeleted = deleteUserFromFile(userId);
-		if (!isDeleted)
-		{
-			std::cout << "User with ID " << userId << " not found.\n";
-		}
-	}
-
-	// Update a user's record based on user ID, field name, and new value
-	void updateUser(const std::string &userId, const std::string &fieldName, const std::string &newValue)
-	{
-		// Retrieve user object from ID
-		auto user = getUserById(userId);
-		if (!user)
-		{
-			std::cerr << "User with ID " << userId << " not found.\n";
-			return;
-		}
-
-		Role role = user->role;
-
-		// Handle Admin user updates
-		if (role == Role::Admin)
-		{
-			auto admin = std::dynamic_pointer_cast<Admin>(user);
-			if (!admin)
-			{
-				std::cerr << "Failed to cast User to Admin for user ID " << userId << ".\n";
-				return;
-			}
-
-			// Define allowed fields for Admin updates and corresponding update logic
-			std::unordered_map<std::string, std::function<void(const std::string &)>> adminUpdates = {
-				{"username", [&admin](const std::string &value)
-				 { admin->username = value; }},
-				{"password", [&admin](const std::string &value)
-				 { admin->password = value; }},
-				{"fullName", [&admin](const std::string &value)
-				 { admin->fullName = value; }},
-				{"email", [&admin](const std::string &value)
-				 { admin->email = value; }},
-				{"contactNumber", [&admin](const std::string &value)
-				 { admin->contactNumber = value; }},
-			};
-
-			// Apply update if field is valid
-			auto it = adminUpdates.find(fieldName);
-			if (it != adminUpdates.end())
-			{
-				it->second(newValue);
-				admin->saveToFile(); // Save changes to file storage
-			}
-			else
-			{
-				std::cerr << "Field '" << fieldName << "' is not valid for Admin.\n";
-			}
-			return;
-		}
-
-		// Handle Patient user updates
-		if (role == Role::Patient)
-		{
-			auto patient = std::dynamic_pointer_cast<Patient>(user);
-			if (!patient)
-			{
-				std::cerr << "Failed to cast User to Patient for user ID " << userId << ".\n";
-				return;
-			}
-
-			// Define allowed fields for Patient updates and corresponding update logic
-			std::unordered_map<std::string, std::function<void(const std::string &)>> patientUpdates = {
-				// Personal Information
-				{"age", [&patient](const std::string &value)
-				 { patient->age = std::stoi(value); }},
-				{"fullName", [&patient](const std::string &value)
-				 { patient->fullName = value; }},
-				{"religion", [&patient](const std::string &value)
-				 { patient->religion = value; }},
-				{"nationality", [&patient](const std::string &value)
-				 { patient->nationality = value; }},
-				{"identityCardNumber", [&patient](const std::string &value)
-				 { patient->identityCardNumber = value; }},
-				{"maritalStatus", [&patient](const std::string &value)
-				 { patient->maritalStatus = value; }},
-				{"gender", [&patient](const std::string &value)
-				 { patient->gender = value; }},
-				{"race", [&patient](const std::string &value)
-				 { patient->race = value; }},
-
-				// Contact Information
-				{"email", [&patient](const std::string &value)
-				 { patient->email = value; }},
-				{"contactNumber", [&patient](const std::string &value)
-				 { patient->contactNumber = value; }},
-				{"emergencyContactNumber", [&patient](const std::string &value)
-				 { patient->emergencyContactNumber = value; }},
-				{"emergencyContactName", [&patient](const std::string &value)
-				 { patient->emergencyContactName = value; }},
-				{"address", [&patient](const std::string &value)
-				 { patient->address = value; }},
-				{"username", [&patient](const std::string &value)
-				 { patient->username = value; }},
-				{"password", [&patient](const std::string &value)
-				 { patient->password = value; }},
-				{"bmi", [&patient](const std::string &value)
-				 { patient->bmi = std::stod(value); }},
-
-				// Medical Information
-				{"height", [&patient](const std::string &value)
-				 { patient->height = value; }},
-				{"weight", [&patient](const std::string &value)
-				 { patient->weight = value; }},
-			};
-
-			// Apply update if field is valid
-			auto it = patientUpdates.find(fieldName);
-			if (it != patientUpdates.end())
-			{
-				it->second(newValue);
-				patient->saveToFile(); // Save changes to file storage
-			}
-			else
-			{
-				std::cerr << "Field '" << fieldName << "' is not valid for Patient.\n";
-			}
-			return;
-		}
-
-		// Handle unknown roles
-		std::cerr << "Unknown role for user ID " << userId << ".\n";
-	}
-	// Validate user credentials and check if the user is an Admin
-	bool validateUser(const std::string &username, const std::string &password)
-	{
-		auto user = getUserByUsername(username);
-
-		// Ensure the user exists, is an Admin, and the password matches
-		if (user && user->getRole() == Role::Admin && user->getPassword() == password)
-		{
-			setCurrentUser(user); // Set the current user
-			return true;
-		}
-		return false;
-	}
-
-	// Count the number of Admin users by checking files in the admin directory
-	int getAdminCount()
-	{
-		std::string filePath = "db/admin/";
-		int count = 0;
-
-		// Check if the directory exists and is valid
-		if (std::filesystem::exists(filePath) && std::filesystem::is_directory(filePath))
-		{
-			// Iterate through files in the directory
-			for (const auto &entry : std::filesystem::directory_iterator(filePath))
-			{
-				if (std::filesystem::is_regular_file(entry))
-				{
-					++count;
-				}
-			}
-		}
-		return count;
-	}
-
-	// Count the number of Patient users by checking files in the patient directory
-	int getPatientCount()
-	{
-		std::string filePath = "db/patient/";
-		int count = 0;
-
-		// Check if the directory exists and is valid
-		if (std::filesystem::exists(filePath) && std::filesystem::is_directory(filePath))
-		{
-			// Iterate through files in the directory
-			for (const auto &entry : std::filesystem::directory_iterator(filePath))
-			{
-				if (std::filesystem::is_regular_file(entry))
-				{
-					++count;
-				}
-			}
-		}
-		return count;
-	}
-
-	// Set the current user
-	void setCurrentUser(std::shared_ptr<User> user)
-	{
-		currentUser = user;
-	}
-
-	// Get the current user
-	const std::shared_ptr<User> &getCurrentUser() const
-	{
-		return currentUser;
-	}
-
-	// Retrieve a list of Admins based on a search query
-	std::vector<std::pair<std::string, std::string>> getAdmins(const std::string &query)
-	{
-		std::vector<std::pair<std::shared_ptr<User>, std::string>> tempRes;
-		std::string filteredQuery = query.empty() ? "" : toLower(trim(query));
-
-		// Iterate through user records and filter for Admins
-		for (const auto &pair : userMap)
-		{
-			const std::shared_ptr<User> &userPtr = pair.second;
-			if (userPtr && userPtr->role == Role::Admin)
-			{
-				// Check if the query matches full name, ID, or username
-				if (filteredQuery.empty() ||
-					toLower(userPtr->getFullName()).find(filteredQuery) != std::string::npos ||
-					toLower(userPtr->getId()).find(filteredQuery) != std::string::npos ||
-					toLower(userPtr->getUsername()).find(filteredQuery) != std::string::npos)
-				{
-					tempRes.push_back({userPtr, userPtr->getId()});
-				}
-			}
-		}
-
-		// Sort by createdAt in descending order (newest first)
-		std::sort(tempRes.begin(), tempRes.end(), [](const auto &a, const auto &b)
-				  { return a.first->createdAt > b.first->createdAt; });
-
-		// Store results as pairs of (fullName, userId)
-		std::vector<std::pair<std::string, std::string>> res;
-		for (const auto &entry : tempRes)
-		{
-			res.push_back({entry.first->getFullName(), entry.second});
-		}
-		return res;
-	}
-
-	// Retrieve a list of Patients based on a search query
-	std::vector<std::pair<std::string, std::string>> getPatients(const std::string &query)
-	{
-		std::vector<std::pair<std::shared_ptr<User>, std::string>> tempRes;
-		std::string filteredQuery = query.empty() ? "" : toLower(trim(query));
-
-		// Iterate through user records and filter for Patients
-		for (const auto &pair : userMap)
-		{
-			const std::shared_ptr<User> &userPtr = pair.second;
-			if (userPtr && userPtr->role == Role::Patient)
-			{
-				// Check if the query matches full name, ID, or username
-				if (filteredQuery.empty() ||
-					toLower(userPtr->getFullName()).find(filteredQuery) != std::string::npos ||
-					toLower(userPtr->getId()).find(filteredQuery) != std::string::npos ||
-					toLower(userPtr->getUsername()).find(filteredQuery) != std::string::npos)
-				{
-					tempRes.push_back({userPtr, userPtr->getId()});
-				}
-			}
-		}
-
-		// Sort by createdAt in descending order (newest first)
-		std::sort(tempRes.begin(), tempRes.end(), [](const auto &a, const auto &b)
-				  { return a.first->createdAt > b.first->createdAt; });
-
-		// Store results as pairs of (fullName, userId)
-		std::vector<std::pair<std::string, std::string>> res;
-		for (const auto &entry : tempRes)
-		{
-			res.push_back({entry.first->getFullName(), entry.second});
-		}
-		return res;
-	}
-};
-
-#endif // USER_MANAGER_H
+#ifndef USER_MANAGER_H
+#define USER_MANAGER_H
+
+#include <unordered_map> // Used for storing and managing user data efficiently
+#include <map>			 // Holds the admission counters by department
+#include <memory>		 // Enables the use of smart pointers (std::shared_ptr, std::unique_ptr)
+#include <mutex>		 // Guards userMap against the background checkpoint thread
+#include <thread>		 // Runs the background checkpoint thread
+#include <condition_variable> // Wakes the checkpoint thread on its interval or at shutdown
+#include <atomic>		 // Hands out file chunks to the startup loader threads and stops a checkpoint at shutdown
+#include <exception>	 // Carries parse errors from loader threads back to the caller
+
+// User-related class headers
+#include "User.hpp"	   // Base class for different user roles (Admin, Patient)
+#include "Admin.hpp"   // Derived class representing Admin users
+#include "Patient.hpp" // Derived class representing Patient users
+
+// Utility functions
+#include "utils.hpp" // Helper functions (e.g., string manipulation, validation)
+
+// Admissions management
+#include "admissions.hpp" // Manages patient admissions and related operations
+
+// Persistence
+#include "Config.hpp"	 // Runtime options such as the storage mode
+#include "RecordLog.hpp" // Append-only change log used in log storage mode
+#include "Checkpoint.hpp" // Consolidated snapshot of every record
+#include "RecordFile.hpp" // Reads and writes per-record files in the configured format
+#include "RecordDecoder.hpp" // Decodes record files without building a json document
+#include "SnapshotDecoder.hpp" // Decodes the checkpoint snapshot the same way, as a stream
+#include "LogRecordDecoder.hpp" // Decodes change log records the same way while the log is replayed
+#include "SearchIndex.hpp"   // Trigram index behind the Database screen search
+#include "UserCache.hpp"	 // Bounds the full patient records kept in memory in lazy mode
+#include "DeleteQueue.hpp"	 // Removes deleted record files in the background
+#include "RecordWriter.hpp"	 // Writes saved record files in the background
+
+// One page of search results
+struct UserPage
+{
+	std::vector<std::pair<std::string, std::string>> records; // (fullName, userId) of the page, newest first
+	size_t total = 0;										  // Number of matches over all pages
+};
+
+// Matches of one search, kept so that pages can be read from them and a longer query can refine them
+struct UserSearch
+{
+	Role role = Role::Patient;		// Role that was searched
+	std::string query;				// Query as given
+	std::uint64_t changeCount = 0;	// UserManager change count when the search ran
+	bool everyone = false;			// Empty query: pages come straight from the creation order
+	SearchIndex::Matches matches;	// Matching users, ordered as far as pages were read (empty when everyone is set)
+};
+
+// The UserManager class is responsible for managing the CRUD operations of user-related objects
+class UserManager
+{
+private:
+	// In-memory storage of users as shared pointers for fast lookups
+	std::unordered_map<std::string, std::shared_ptr<User>> userMap;
+	// Summary of every stored user (ID, username, full name, role, createdAt), loaded or not
+	std::unordered_map<std::string, UserSummary> summaries;
+	// Normalized (trimmed, lowercase) username -> user ID, kept in step with summaries
+	std::unordered_map<std::string, std::string> usernameIndex;
+	// Normalized full name -> IDs of every user with that name (names are not unique)
+	std::unordered_multimap<std::string, std::string> nameIndex;
+	// Substring search over ID, username and full name, one index per role
+	SearchIndex adminSearch;
+	SearchIndex patientSearch;
+	// Number of stored users per role and of admissions per department, kept in step with summaries
+	int adminCount = 0;
+	int patientCount = 0;
+	std::map<Admissions::Department, int> admissionCounts;
+	std::shared_ptr<User> currentUser; // Currently logged-in user
+
+	StorageMode storageMode; // How records are persisted (per-record files or change log)
+	bool lazyLoad;			 // Load only patient summaries at startup and read full patients on demand
+	UserCache patientCache;	 // Least-recently-used budget for the full patients loaded in lazy mode
+	RecordWriter recordWriter; // Background writer of record files in files mode
+	RecordLog recordLog;	 // Change log appended to in log storage mode
+	const std::string recordLogPath = "db/records.log";
+	DeleteQueue deleteQueue; // Background removal of deleted record files (files mode with HMS_ASYNC_DELETE=1)
+	const std::string tombstonePath = "db/tombstones.log";
+
+	// Checkpointing state; every mutation of userMap or a user happens under this mutex
+	std::recursive_mutex mutex;
+	std::uint64_t changeCount = 0;			   // Number of changes applied since startup
+	std::uint64_t checkpointedChangeCount = 0; // changeCount covered by the latest checkpoint
+	bool checkpointValid = false;			   // Whether db/snapshot.marker matches the store (files mode)
+	std::thread checkpointThread;			   // Background compactor
+	std::mutex checkpointWaitMutex;
+	std::condition_variable checkpointCv;
+	std::atomic<bool> stopCheckpoints{false}; // Set under checkpointWaitMutex; also ends a checkpoint being written
+
+	// Singleton constructor: private to prevent direct instantiation
+	UserManager()
+		: storageMode(Config::getInstance().storageMode),
+		  lazyLoad(Config::getInstance().lazyLoad && storageMode == StorageMode::Files),
+		  patientCache(lazyLoad ? Config::getInstance().cacheUsers : 0,
+					   lazyLoad ? static_cast<size_t>(Config::getInstance().cacheMb) * 1024 * 1024 : 0),
+		  recordWriter(storageMode == StorageMode::Files ? Config::getInstance().writeQueue : 0)
+	{
+		RecordSync::getInstance(); // Created first so that it outlives this singleton and commits its staged writes last
+		populateUserMap();		   // Load all users into memory
+
+		int interval = Config::getInstance().checkpointSeconds;
+		if (interval > 0)
+		{
+			checkpointThread = std::thread(&UserManager::runCheckpoints, this, interval);
+		}
+	}
+	~UserManager()
+	{
+		if (checkpointThread.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(checkpointWaitMutex);
+				stopCheckpoints = true;
+			}
+			checkpointCv.notify_one();
+			checkpointThread.join();
+		}
+	}
+	UserManager(const UserManager &) = delete;
+	UserManager &operator=(const UserManager &) = delete;
+
+	// Decode one record file into the user object for its role (nullptr for unknown roles)
+	static std::shared_ptr<User> readUserFile(const std::filesystem::path &filePath, const std::string &role)
+	{
+		if (!std::filesystem::exists(filePath))
+		{
+			return nullptr;
+		}
+
+		// Stream the record straight into the appropriate user object
+		if (role == "admin")
+		{
+			auto admin = std::make_shared<Admin>();
+			RecordDecoder::decode(filePath, *admin);
+			return admin;
+		}
+		if (role == "patient")
+		{
+			auto patient = std::make_shared<Patient>();
+			RecordDecoder::decode(filePath, *patient);
+			return patient;
+		}
+		return nullptr;
+	}
+
+	// Decode only the summary fields of a record file; the admissions log is skipped while parsing
+	static UserSummary readSummaryFile(const std::filesystem::path &filePath)
+	{
+		UserSummary summary;
+		RecordDecoder::decode(filePath, summary);
+		return summary;
+	}
+
+	// Key under which a username or full name is indexed
+	static std::string normalizeKey(const std::string &username)
+	{
+		return toLower(trim(username));
+	}
+
+	// Search index holding users of a role (nullptr for roles that are not listed)
+	SearchIndex *searchIndexFor(Role role)
+	{
+		switch (role)
+		{
+		case Role::Admin:
+			return &adminSearch;
+		case Role::Patient:
+			return &patientSearch;
+		default:
+			return nullptr;
+		}
+	}
+
+	// Add (sign 1) or remove (sign -1) a summary's user and admissions from the counters
+	void tally(const UserSummary &summary, int sign)
+	{
+		if (summary.role == Role::Admin)
+			adminCount += sign;
+		else if (summary.role == Role::Patient)
+			patientCount += sign;
+		for (const auto &[dept, admissions] : summary.admissionCounts)
+		{
+			int &total = admissionCounts[dept];
+			total += sign * admissions;
+			if (total == 0)
+				admissionCounts.erase(dept);
+		}
+	}
+
+	// Make a user known to the lookup structures, replacing what was indexed for it before
+	void indexSummary(const UserSummary &summary)
+	{
+		auto it = summaries.find(summary.id);
+		if (it == summaries.end())
+		{
+			it = summaries.emplace(summary.id, summary).first;
+			tally(it->second, 1);
+			usernameIndex[normalizeKey(summary.username)] = summary.id;
+			nameIndex.emplace(normalizeKey(summary.fullName), summary.id);
+			if (SearchIndex *index = searchIndexFor(summary.role))
+				index->add(it->second);
+			return;
+		}
+
+		UserSummary &stored = it->second;
+		tally(stored, -1);
+		tally(summary, 1);
+		if (stored.username != summary.username)
+		{
+			unindexUsername(stored);
+		}
+		bool nameChanged = normalizeKey(stored.fullName) != normalizeKey(summary.fullName);
+		if (nameChanged)
+		{
+			unindexName(stored);
+		}
+
+		// The search index orders users by creation time, so a new timestamp re-adds the user like a new role
+		if (stored.role != summary.role || stored.createdAt != summary.createdAt)
+		{
+			if (SearchIndex *index = searchIndexFor(stored.role))
+				index->remove(stored);
+			stored = summary;
+			if (SearchIndex *index = searchIndexFor(stored.role))
+				index->add(stored);
+		}
+		else if (stored.username != summary.username || stored.fullName != summary.fullName)
+		{
+			std::string oldUsername = stored.username, oldFullName = stored.fullName;
+			stored = summary;
+			if (SearchIndex *index = searchIndexFor(stored.role))
+				index->update(stored, oldUsername, oldFullName);
+		}
+		else
+		{
+			stored = summary;
+		}
+
+		usernameIndex[normalizeKey(summary.username)] = summary.id;
+		if (nameChanged)
+		{
+			nameIndex.emplace(normalizeKey(summary.fullName), summary.id);
+		}
+	}
+
+	// Make a loaded user known to the lookup structures, counting a patient's admissions
+	void indexUser(const std::shared_ptr<User> &user)
+	{
+		UserSummary summary(*user);
+		if (auto patient = std::dynamic_pointer_cast<Patient>(user))
+		{
+			summary.admissionCounts = patient->admissions.counts();
+		}
+		indexSummary(summary);
+	}
+
+	// Drop a user's username from the index unless another user has since taken it over
+	void unindexUsername(const UserSummary &summary)
+	{
+		auto it = usernameIndex.find(normalizeKey(summary.username));
+		if (it != usernameIndex.end() && it->second == summary.id)
+		{
+			usernameIndex.erase(it);
+		}
+	}
+
+	// Drop a user's entry from the full-name index
+	void unindexName(const UserSummary &summary)
+	{
+		auto range = nameIndex.equal_range(normalizeKey(summary.fullName));
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (it->second == summary.id)
+			{
+				nameIndex.erase(it);
+				return;
+			}
+		}
+	}
+
+	// Forget a user in the lookup structures
+	void unindexUser(const std::string &userId)
+	{
+		auto it = summaries.find(userId);
+		if (it == summaries.end())
+		{
+			return;
+		}
+		tally(it->second, -1);
+		unindexUsername(it->second);
+		unindexName(it->second);
+		if (SearchIndex *index = searchIndexFor(it->second.role))
+			index->remove(it->second);
+		summaries.erase(it);
+	}
+
+	// Search one role's index and list the matches newest first as (fullName, userId) pairs
+	static std::vector<std::pair<std::string, std::string>> searchUsers(const SearchIndex &index, const std::string &query)
+	{
+		// The index keeps its users in creation order, so matches arrive newest first (ties by ID)
+		std::vector<const UserSummary *> tempRes = index.search(query);
+
+		// Store results as pairs of (fullName, userId)
+		std::vector<std::pair<std::string, std::string>> res;
+		res.reserve(tempRes.size());
+		for (const UserSummary *summary : tempRes)
+		{
+			res.push_back({summary->fullName, summary->id});
+		}
+		return res;
+	}
+
+	// Track a full patient in the lazy-mode cache and drop the least recently used patients over the budget.
+	// A patient still referenced outside userMap (the current user, a record open on screen) is pinned.
+	// Only patients are evicted: they are persisted on every change and their summaries stay loaded.
+	void cacheUser(const std::shared_ptr<User> &user)
+	{
+		if (!patientCache.isBounded() || user->role != Role::Patient)
+		{
+			return;
+		}
+
+		patientCache.insert(*user);
+		auto isPinned = [this](const std::string &userId)
+		{
+			auto it = userMap.find(userId);
+			return it != userMap.end() && it->second.use_count() > 1;
+		};
+		for (const std::string &userId : patientCache.evict(isPinned))
+		{
+			userMap.erase(userId);
+		}
+	}
+
+	// Load a user from a file given their user ID and role
+	std::shared_ptr<User> getUserFromFile(const std::string &userId, const std::string &role)
+	{
+		std::shared_ptr<User> user = nullptr;
+		recordWriter.wait(role, userId); // A save of the record may still be queued
+		std::filesystem::path filePath = RecordFile::find(role, userId);
+
+		// Check if the file exists in any format before attempting to read
+		if (!filePath.empty())
+		{
+			user = readUserFile(filePath, role);
+			if (user)
+			{
+				userMap[userId] = user; // Cache the user in memory
+				indexUser(user);
+				cacheUser(user);
+			}
+		}
+		return user;
+	}
+
+	// Drop a stored user from memory and the lookup structures and record the deletion.
+	// Returns the (role, id) of the record file to remove in files mode.
+	DeleteQueue::Removal forgetUser(const std::string &userId)
+	{
+		std::string role = User::getRoleToString(summaries.at(userId).role);
+		userMap.erase(userId);
+		patientCache.erase(userId);
+		unindexUser(userId);
+		markChanged();
+		if (storageMode == StorageMode::Log)
+		{
+			recordLog.append(json{{"op", "delete"}, {"id", userId}});
+		}
+		else
+		{
+			recordWriter.discard(role, userId); // A queued save must not bring the file back
+		}
+		return {role, userId};
+	}
+
+	// Load all user records by reading every per-record file.
+	// The file list is split into chunks that a pool of worker threads claim and parse;
+	// each worker keeps its own results, which are merged into userMap once all workers finish.
+	void scanRecordFiles()
+	{
+		// Enumerate the record files of every role directory
+		std::vector<std::pair<std::filesystem::path, std::string>> files; // (file path, role)
+		std::vector<Role> roles = {Role::Admin, Role::Patient, Role::User};
+		for (const auto &role : roles)
+		{
+			std::string roleStr = User::getRoleToString(role);
+			std::string filePath = "db/" + roleStr + "/";
+
+			if (!std::filesystem::exists(filePath))
+			{
+				std::cerr << "Directory not found: " << filePath << std::endl;
+				continue;
+			}
+
+			// Flat or sharded, depending on the configured layout
+			for (const auto &path : RecordFile::list(roleStr))
+			{
+				files.emplace_back(path, roleStr);
+			}
+		}
+
+		const size_t chunkSize = 256;
+		const size_t chunkCount = (files.size() + chunkSize - 1) / chunkSize;
+		size_t threadCount = Config::getInstance().loaderThreads;
+		if (threadCount == 0)
+		{
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+		threadCount = std::max<size_t>(1, std::min(threadCount, chunkCount));
+
+		// Per-worker output: fully loaded users, plus summaries of patients left unloaded in lazy mode
+		struct LoadResult
+		{
+			std::vector<std::shared_ptr<User>> users;
+			std::vector<UserSummary> summaries;
+		};
+		std::vector<LoadResult> results(threadCount);
+		std::vector<std::exception_ptr> errors(threadCount);
+		std::atomic<size_t> nextChunk{0};
+
+		// Each worker claims the next unparsed chunk until none are left
+		auto worker = [&](size_t index)
+		{
+			try
+			{
+				for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+				{
+					size_t end = std::min(files.size(), (chunk + 1) * chunkSize);
+					for (size_t i = chunk * chunkSize; i < end; ++i)
+					{
+						if (lazyLoad && files[i].second == "patient")
+						{
+							results[index].summaries.push_back(readSummaryFile(files[i].first));
+							continue;
+						}
+						std::shared_ptr<User> user = readUserFile(files[i].first, files[i].second);
+						if (user)
+						{
+							results[index].users.push_back(user);
+						}
+					}
+				}
+			}
+			catch (...)
+			{
+				errors[index] = std::current_exception();
+				nextChunk = chunkCount; // Stop the other workers early
+			}
+		};
+
+		// The calling thread works too, so a single-threaded load spawns nothing
+		std::vector<std::thread> workers;
+		for (size_t t = 1; t < threadCount; ++t)
+		{
+			workers.emplace_back(worker, t);
+		}
+		worker(0);
+		for (auto &thread : workers)
+		{
+			thread.join();
+		}
+
+		// A corrupt record aborts the load just like a sequential scan would
+		for (const auto &error : errors)
+		{
+			if (error)
+			{
+				std::rethrow_exception(error);
+			}
+		}
+
+		size_t loaded = 0, total = 0;
+		for (const auto &result : results)
+		{
+			loaded += result.users.size();
+			total += result.users.size() + result.summaries.size();
+		}
+		userMap.reserve(userMap.size() + loaded);
+		summaries.reserve(summaries.size() + total);
+		usernameIndex.reserve(usernameIndex.size() + total);
+		nameIndex.reserve(nameIndex.size() + total);
+		patientSearch.reserve(total);
+		for (const auto &result : results)
+		{
+			for (const auto &user : result.users)
+			{
+				userMap[user->getId()] = user;
+				indexUser(user);
+			}
+			for (const auto &summary : result.summaries)
+			{
+				indexSummary(summary);
+			}
+		}
+	}
+
+	// Add every user decoded from a checkpoint snapshot to userMap (patients only as summaries in lazy mode)
+	void loadSnapshot(const SnapshotDecoder &snapshot)
+	{
+		size_t total = snapshot.admins.size() + snapshot.patients.size() + snapshot.summaries.size();
+		userMap.reserve(userMap.size() + snapshot.admins.size() + snapshot.patients.size());
+		summaries.reserve(summaries.size() + total);
+		usernameIndex.reserve(usernameIndex.size() + total);
+		nameIndex.reserve(nameIndex.size() + total);
+		patientSearch.reserve(snapshot.patients.size() + snapshot.summaries.size());
+		for (const auto &admin : snapshot.admins)
+		{
+			userMap[admin->getId()] = admin;
+			indexUser(admin);
+		}
+		for (const auto &patient : snapshot.patients)
+		{
+			userMap[patient->getId()] = patient;
+			indexUser(patient);
+		}
+		for (const auto &summary : snapshot.summaries)
+		{
+			indexSummary(summary);
+		}
+	}
+
+	// Decode the checkpoint snapshot if it was written by the given storage mode.
+	// A summary-only snapshot (written in lazy mode) is only usable in lazy mode, and only if it
+	// carries counters: older ones have no admission counts in their patient summaries.
+	// A snapshot holding a record that does not decode is unusable, like a missing one, and the
+	// caller loads the store the way it would without a snapshot.
+	bool readSnapshot(SnapshotDecoder &snapshot, StorageMode mode)
+	{
+		std::string storage = mode == StorageMode::Log ? "log" : "files";
+		if (!Checkpoint::hasSnapshot())
+		{
+			return false;
+		}
+		// A snapshot the other storage mode wrote is not decoded just to be rejected. A newer snapshot
+		// whose marker was never written is skipped with it, which loses nothing: the log is only
+		// compacted once the marker is down, so it still holds every record that snapshot covered.
+		std::string markerStorage = Checkpoint::markerStorage();
+		if (!markerStorage.empty() && markerStorage != storage)
+		{
+			return false;
+		}
+		try
+		{
+			if (!Checkpoint::read(snapshot) || snapshot.storage != storage)
+			{
+				return false;
+			}
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << "Warning: Ignoring checkpoint " << Checkpoint::snapshotPath << ": " << e.what() << std::endl;
+			return false;
+		}
+		return snapshot.kind == "full" || (lazyLoad && snapshot.hasCounts);
+	}
+
+	// Serialize the patient cache counters (recorded in the checkpoint marker for tuning)
+	json cacheStatsToJson() const
+	{
+		UserCache::Stats stats = patientCache.getStats();
+		return json{{"hits", stats.hits}, {"misses", stats.misses}, {"evictions", stats.evictions}, {"users", stats.users}, {"bytes", stats.bytes}};
+	}
+
+	// Serialize the record counters
+	json countsToJson() const
+	{
+		json admissions = json::object();
+		for (const auto &[dept, count] : admissionCounts)
+		{
+			admissions[Admissions::departmentToString(dept)] = count;
+		}
+		return json{{"admins", adminCount}, {"patients", patientCount}, {"admissions", admissions}};
+	}
+
+	// Refuse to load record files while some are still stored in the layout HMS_LAYOUT does not select:
+	// they would neither be loaded nor found, so the store would look empty or partial
+	static void checkLayout()
+	{
+		if (RecordFile::isMigratingLayout())
+		{
+			throw std::runtime_error(std::string("A layout migration did not finish (") + RecordFile::layoutMigrationPath +
+									 " is present); run --migrate-layout again to move the remaining records");
+		}
+
+		RecordLayout layout = Config::getInstance().recordLayout;
+		RecordLayout other = layout == RecordLayout::Flat ? RecordLayout::Sharded : RecordLayout::Flat;
+		for (const std::string role : {"admin", "patient"})
+		{
+			if (RecordFile::hasRecords(role, other))
+			{
+				std::string found = other == RecordLayout::Flat ? "flat" : "sharded";
+				std::string wanted = layout == RecordLayout::Flat ? "flat" : "sharded";
+				throw std::runtime_error("db/" + role + " holds records in the " + found + " layout but HMS_LAYOUT is " +
+										 wanted + "; run --migrate-layout to move them first");
+			}
+		}
+	}
+
+	// Load all user records in files mode: from the checkpoint when it is current, otherwise file by file
+	void loadFromFiles()
+	{
+		checkLayout();
+
+		// Finish the removals a previous run had queued, so deleted users are not loaded again,
+		// and delete the staged writes it never renamed into place
+		DeleteQueue::replay(tombstonePath);
+		for (const std::string role : {"admin", "patient", "user"})
+		{
+			RecordFile::removeStaged(role);
+		}
+		if (Config::getInstance().asyncDelete)
+		{
+			deleteQueue.open(tombstonePath);
+		}
+
+		SnapshotDecoder snapshot(Checkpoint::snapshotPath, lazyLoad);
+		if (Checkpoint::hasMarker() && readSnapshot(snapshot, StorageMode::Files))
+		{
+			loadSnapshot(snapshot);
+			checkpointValid = true;
+			return;
+		}
+
+		scanRecordFiles();
+		changeCount = 1; // Write a checkpoint at the next opportunity so the next start is faster
+	}
+
+	// Rebuild userMap from the latest checkpoint plus the change log records it does not cover.
+	// On the first start in log mode the existing per-record files are imported into a fresh log.
+	void loadFromLog()
+	{
+		SnapshotDecoder snapshot(Checkpoint::snapshotPath, lazyLoad);
+		std::uint64_t baseSeq = 0;
+		bool haveSnapshot = readSnapshot(snapshot, StorageMode::Log);
+		if (haveSnapshot)
+		{
+			loadSnapshot(snapshot);
+			baseSeq = snapshot.seq;
+		}
+
+		bool importFiles = !haveSnapshot && !std::filesystem::exists(recordLogPath);
+		std::uint64_t lastSeq = baseSeq;
+		if (importFiles)
+		{
+			checkLayout();
+			scanRecordFiles();
+		}
+		else
+		{
+			std::filesystem::path logPath = recordLogPath;
+			RecordLog::replay(recordLogPath, [this, baseSeq, &lastSeq, &logPath](const std::string &line)
+							  {
+								  LogRecordDecoder record = LogRecordDecoder::read(line, logPath);
+								  if (coveredByCheckpoint(baseSeq, record.seq))
+									  return;
+								  applyLogRecord(record);
+								  lastSeq = std::max(lastSeq, record.seq); });
+			if (lastSeq > baseSeq)
+			{
+				changeCount = 1; // The log has records beyond the checkpoint
+			}
+		}
+
+		recordLog.setLastSeq(lastSeq);
+		if (!recordLog.open(recordLogPath, Config::getInstance().groupCommitMs))
+		{
+			throw std::runtime_error("Could not open the record log " + recordLogPath);
+		}
+		if (importFiles)
+		{
+			for (const auto &pair : userMap)
+			{
+				recordLog.append(makeCreateRecord(pair.second));
+			}
+			if (!recordLog.flush())
+			{
+				recordLog.close();
+				std::filesystem::remove(recordLogPath); // The next start imports the files again
+				throw std::runtime_error("Could not write the imported records to " + recordLogPath);
+			}
+		}
+	}
+
+	// Check whether a log record is already reflected in the checkpoint taken at baseSeq
+	static bool coveredByCheckpoint(std::uint64_t baseSeq, std::uint64_t seq)
+	{
+		return baseSeq > 0 && seq <= baseSeq;
+	}
+
+	// Append users to a snapshot being written, comma-separated, each serialized by dump. They are
+	// serialized a batch at a time under the lock, which is released while the batch is written out.
+	// Returns false, abandoning the snapshot, once a write fails, shutdown begins or a change since
+	// generation makes the snapshot stale (the users may then have been deleted, so none is touched after that).
+	template <typename T, typename Dump>
+	bool writeSnapshotUsers(Checkpoint::SnapshotWriter &writer, const std::vector<T> &users, std::uint64_t generation, Dump dump)
+	{
+		const size_t batchSize = 1000;
+		std::string batch;
+		for (size_t start = 0; start < users.size(); start += batchSize)
+		{
+			batch.clear();
+			{
+				std::lock_guard<std::recursive_mutex> lock(mutex);
+				if (changeCount != generation || stopCheckpoints)
+				{
+					return false;
+				}
+				for (size_t i = start; i < std::min(users.size(), start + batchSize); ++i)
+				{
+					if (i > 0)
+					{
+						batch += ',';
+					}
+					batch += dump(users[i]);
+				}
+			}
+			if (!writer.write(batch))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Write a checkpoint of userMap if anything changed since the last one.
+	// Only the users to write, the counters and the log position are collected under the lock; the
+	// snapshot is then streamed to disk record by record (see writeSnapshotUsers), so it never exists
+	// as one document in memory. A change made meanwhile abandons it until the next interval: the
+	// snapshot would mix states from before and after the log position it claims to cover.
+	// In lazy mode not every patient is loaded, so patients are written as summaries only.
+	// In log mode the records covered by the checkpoint are then dropped from the log.
+	void checkpoint()
+	{
+		std::vector<std::shared_ptr<User>> admins;
+		std::vector<std::shared_ptr<User>> patients;
+		std::vector<const UserSummary *> patientSummaries; // Stable until the user is deleted, which is a change
+		json counts;
+		std::uint64_t generation;
+		std::uint64_t seq = 0;
+		{
+			std::lock_guard<std::recursive_mutex> lock(mutex);
+
+			if (changeCount == checkpointedChangeCount)
+			{
+				return;
+			}
+			for (const auto &pair : userMap)
+			{
+				if (pair.second->role == Role::Admin)
+				{
+					admins.push_back(pair.second);
+				}
+				else if (pair.second->role == Role::Patient && !lazyLoad)
+				{
+					patients.push_back(pair.second);
+				}
+			}
+			if (lazyLoad)
+			{
+				for (const auto &pair : summaries)
+				{
+					if (pair.second.role == Role::Patient)
+					{
+						patientSummaries.push_back(&pair.second);
+					}
+				}
+			}
+			counts = countsToJson();
+			generation = changeCount;
+			if (storageMode == StorageMode::Log)
+			{
+				seq = recordLog.getLastSeq();
+			}
+		}
+
+		// Keys in sorted order, as a dumped document has them: readers rely on kind preceding patients
+		std::string storage = storageMode == StorageMode::Log ? "log" : "files";
+		Checkpoint::SnapshotWriter writer;
+		bool written = writer.write("{\"admins\":[") &&
+					   writeSnapshotUsers(writer, admins, generation, [](const std::shared_ptr<User> &user)
+										  { return json(*std::dynamic_pointer_cast<Admin>(user)).dump(); }) &&
+					   writer.write("],\"counts\":" + counts.dump() + ",\"kind\":\"" + (lazyLoad ? "summary" : "full") + "\",\"patients\":[") &&
+					   (lazyLoad ? writeSnapshotUsers(writer, patientSummaries, generation, [](const UserSummary *summary)
+													  { return summary->toJson().dump(); })
+								 : writeSnapshotUsers(writer, patients, generation, [](const std::shared_ptr<User> &user)
+													  { return json(*std::dynamic_pointer_cast<Patient>(user)).dump(); })) &&
+					   writer.write("],\"seq\":" + std::to_string(seq) + ",\"storage\":" + json(storage).dump() + "}");
+		if (!written || !writer.commit())
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::recursive_mutex> lock(mutex);
+
+			// In files mode a change made while the snapshot was written makes it stale already
+			if (storageMode == StorageMode::Files && changeCount != generation)
+			{
+				return;
+			}
+			json marker = {{"storage", storage},
+						   {"seq", seq},
+						   {"admins", admins.size()},
+						   {"patients", lazyLoad ? patientSummaries.size() : patients.size()},
+						   {"admissions", counts["admissions"]},
+						   {"cache", cacheStatsToJson()},
+						   {"createdAt", formatTimestamp(std::chrono::system_clock::now())}};
+			if (!Checkpoint::writeMarker(marker))
+			{
+				return;
+			}
+			checkpointValid = true;
+			checkpointedChangeCount = generation;
+		}
+
+		// Records that could not be committed are kept in memory; compact once they are on disk
+		if (storageMode == StorageMode::Log && recordLog.flush())
+		{
+			recordLog.compactThrough(seq);
+		}
+	}
+
+	// Background compactor: checkpoint every intervalSeconds until shutdown. The first checkpoint is
+	// written right away, so a store just loaded by scanning its record files (or with log records
+	// beyond the last checkpoint) gets one even if the application exits before the first interval.
+	void runCheckpoints(int intervalSeconds)
+	{
+		checkpoint();
+		std::unique_lock<std::mutex> lock(checkpointWaitMutex);
+		while (!stopCheckpoints)
+		{
+			checkpointCv.wait_for(lock, std::chrono::seconds(intervalSeconds), [this]
+								  { return stopCheckpoints.load(); });
+			if (stopCheckpoints)
+			{
+				break;
+			}
+			lock.unlock();
+			checkpoint();
+			lock.lock();
+		}
+	}
+
+	// Record that the store changed so the next checkpoint picks it up.
+	// In files mode the record files are authoritative, so the current checkpoint stops being valid.
+	void markChanged()
+	{
+		++changeCount;
+		if (storageMode == StorageMode::Files && checkpointValid)
+		{
+			Checkpoint::invalidate();
+			checkpointValid = false;
+		}
+	}
+
+	// Load all user records from the configured storage into memory
+	void populateUserMap()
+	{
+		if (storageMode == StorageMode::Log)
+		{
+			loadFromLog();
+		}
+		else
+		{
+			loadFromFiles();
+		}
+	}
+
+	// Serialize a user with the fields of its role
+	static json toRecord(const std::shared_ptr<User> &user)
+	{
+		if (user->role == Role::Admin)
+		{
+			return *std::dynamic_pointer_cast<Admin>(user);
+		}
+		return *std::dynamic_pointer_cast<Patient>(user);
+	}
+
+	// Build a create change record holding the full serialized user. The role is part of op and the
+	// user goes under "user", which sorts after "op", so a replay knows what to decode it into first.
+	static json makeCreateRecord(const std::shared_ptr<User> &user)
+	{
+		return json{{"op", "create-" + User::getRoleToString(user->role)}, {"user", toRecord(user)}};
+	}
+
+	// Apply one replayed change record to userMap
+	void applyLogRecord(const LogRecordDecoder &record)
+	{
+		if (record.op == "create")
+		{
+			if (record.user)
+			{
+				userMap[record.user->getId()] = record.user;
+				indexUser(record.user);
+			}
+			return;
+		}
+
+		auto it = userMap.find(record.id);
+		if (it == userMap.end())
+		{
+			return; // Change to a user deleted later in the log
+		}
+
+		if (record.op == "update")
+		{
+			applyFieldUpdate(it->second, record.field, record.value);
+			indexUser(it->second);
+		}
+		else if (record.op == "update-fields")
+		{
+			for (const auto &[fieldName, value] : record.fields)
+			{
+				applyFieldUpdate(it->second, fieldName, value);
+			}
+			indexUser(it->second);
+		}
+		else if (record.op == "add-admission" || record.op == "delete-admission")
+		{
+			auto patient = std::dynamic_pointer_cast<Patient>(it->second);
+			if (!patient)
+				return;
+			Admissions::Department dept = Admissions::stringToDepartment(record.department);
+			if (record.op == "add-admission")
+			{
+				patient->addAdmission(dept, record.dateTime);
+			}
+			else
+			{
+				patient->deleteAdmission(dept, record.dateTime);
+			}
+			indexUser(patient);
+		}
+		else if (record.op == "delete")
+		{
+			unindexUser(it->first);
+			userMap.erase(it);
+		}
+	}
+
+	// Persist a user after a change: append the change record in log mode, rewrite the record file otherwise.
+	// The user is serialized here, on the calling thread; the record file is written by the background writer.
+	void persist(const std::shared_ptr<User> &user, const json &change)
+	{
+		markChanged();
+		if (storageMode == StorageMode::Log)
+		{
+			recordLog.append(change);
+			return;
+		}
+
+		if (user->role == Role::Admin || user->role == Role::Patient)
+		{
+			recordWriter.save(User::getRoleToString(user->role), user->getId(), toRecord(user));
+		}
+	}
+
+	// Apply a single field change to a user in memory; returns false if the field is not valid for the role.
+	// The field is found in the role's field table, so no dispatch map is built per call.
+	bool applyFieldUpdate(const std::shared_ptr<User> &user, const std::string &fieldName, const std::string &newValue)
+	{
+		const std::string &userId = user->getId();
+		Role role = user->role;
+
+		// Handle Admin user updates
+		if (role == Role::Admin)
+		{
+			auto admin = std::dynamic_pointer_cast<Admin>(user);
+			if (!admin)
+			{
+				std::cerr << "Failed to cast User to Admin for user ID " << userId << ".\n";
+				return false;
+			}
+
+			// Apply update if field is valid
+			const FieldDescriptor<Admin> *field = Admin::fieldTable().find(fieldName);
+			if (!field)
+			{
+				std::cerr << "Field '" << fieldName << "' is not valid for Admin.\n";
+				return false;
+			}
+			field->parse(newValue, *admin);
+			return true;
+		}
+
+		// Handle Patient user updates
+		if (role == Role::Patient)
+		{
+			auto patient = std::dynamic_pointer_cast<Patient>(user);
+			if (!patient)
+			{
+				std::cerr << "Failed to cast User to Patient for user ID " << userId << ".\n";
+				return false;
+			}
+
+			// Apply update if field is valid
+			const FieldDescriptor<Patient> *field = Patient::fieldTable().find(fieldName);
+			if (!field)
+			{
+				std::cerr << "Field '" << fieldName << "' is not valid for Patient.\n";
+				return false;
+			}
+			field->parse(newValue, *patient);
+			return true;
+		}
+
+		// Handle unknown roles
+		std::cerr << "Unknown role for user ID " << userId << ".\n";
+		return false;
+	}
+
+public:
+	// Get the singleton instance of UserManager
+	static UserManager &getInstance()
+	{
+		static UserManager instance;
+		return instance;
+	}
+
+	// Create a new patient record and store it in the user map and file system
+	void createPatient(const std::string &username, const std::string &password, int age, const std::string &fullName,
+					   const std::string &religion, const std::string &nationality,
+					   const std::string &identityCardNumber, const std::string &maritalStatus, const std::string &gender,
+					   const std::string &race, const std::string &email, const std::string &contactNumber,
+					   const std::string &emergencyContactNumber, const std::string &emergencyContactName, const std::string &address,
+					   double bmi, const std::string &height, const std::string &weight, Admissions::Department dept)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		// Usernames must be unique across all accounts
+		if (isUsernameTaken(username))
+		{
+			std::cout << "User with username " << username << " already exists.\n";
+			return;
+		}
+
+		// Create a new Patient object
+		std::shared_ptr<Patient> newPatient = std::make_shared<Patient>(
+			username, password, age, fullName, religion, nationality, identityCardNumber,
+			maritalStatus, gender, race, email, contactNumber, emergencyContactNumber, emergencyContactName,
+			address, bmi, height, weight, dept);
+
+		// Try inserting the patient into the user map
+		auto result = userMap.insert({newPatient->getId(), newPatient});
+		if (!result.second)
+		{
+			// User already exists, print an error message
+			std::cout << "Patient with ID " << newPatient->getId() << " already exists.\n";
+			std::cout << "Patient with username " << newPatient->getUsername() << " already exists.\n";
+			return;
+		}
+
+		// Persist the new patient record
+		indexUser(newPatient);
+		persist(newPatient, makeCreateRecord(newPatient));
+		cacheUser(newPatient);
+	}
+
+	// Create a new admin record and store it in the user map and file system
+	void createAdmin(const std::string &username, const std::string &password, const std::string &fullName, const std::string &email, const std::string &contactNumber)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		// Usernames must be unique across all accounts
+		if (isUsernameTaken(username))
+		{
+			std::cout << "User with username " << username << " already exists.\n";
+			return;
+		}
+
+		// Create a new Admin object
+		std::shared_ptr<Admin> newAdmin = std::make_shared<Admin>(username, password, fullName, email, contactNumber);
+
+		// Try inserting the admin into the user map
+		auto result = userMap.insert({newAdmin->getId(), newAdmin});
+		if (!result.second)
+		{
+			// User already exists, print an error message
+			std::cout << "Admin with ID " << newAdmin->getId() << " already exists.\n";
+			std::cout << "Admin with username " << newAdmin->getUsername() << " already exists.\n";
+			return;
+		}
+
+		// Persist the new admin record
+		indexUser(newAdmin);
+		persist(newAdmin, makeCreateRecord(newAdmin));
+	}
+
+	// Retrieve a user record by ID (either from memory or file system)
+	std::shared_ptr<User> getUserById(const std::string &userId)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		// Check if the user is already stored in memory
+		auto it = userMap.find(userId);
+		if (it != userMap.end())
+		{
+			patientCache.hit(userId);
+			return it->second;
+		}
+
+		// In log mode userMap already holds every live user; leftover record files may be stale
+		if (storageMode == StorageMode::Log)
+		{
+			return nullptr;
+		}
+
+		// summaries holds the ID of every stored user (loaded at startup, kept in step on every change),
+		// so an unknown ID does not exist on disk either and needs no filesystem probe
+		auto summaryIt = summaries.find(userId);
+		if (summaryIt == summaries.end())
+		{
+			return nullptr;
+		}
+
+		// A known but not yet loaded user (lazy mode) is read from the file for its role
+		if (patientCache.isBounded())
+		{
+			patientCache.miss();
+		}
+		return getUserFromFile(userId, User::getRoleToString(summaryIt->second.role));
+	}
+
+	// Retrieve a user record by username (case-insensitive, ignoring surrounding whitespace).
+	// The username index covers every stored user, so a miss needs no disk access.
+	std::shared_ptr<User> getUserByUsername(const std::string &username)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		auto it = usernameIndex.find(normalizeKey(username));
+		if (it == usernameIndex.end())
+		{
+			return nullptr;
+		}
+		return getUserById(it->second);
+	}
+
+	// Check whether a username is already used by a user other than exceptUserId
+	bool isUsernameTaken(const std::string &username, const std::string &exceptUserId = "")
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		auto it = usernameIndex.find(normalizeKey(username));
+		return it != usernameIndex.end() && it->second != exceptUserId;
+	}
+
+	// Retrieve every user with the given full name (case-insensitive, ignoring surrounding whitespace).
+	// Names are not unique; matches are returned oldest account first. A miss needs no disk access.
+	std::vector<std::shared_ptr<User>> getUsersByName(const std::string &fullName)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		std::vector<const UserSummary *> matches;
+		auto range = nameIndex.equal_range(normalizeKey(fullName));
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			matches.push_back(&summaries.at(it->second));
+		}
+		std::sort(matches.begin(), matches.end(), [](const UserSummary *a, const UserSummary *b)
+				  { return a->createdAt < b->createdAt; });
+
+		std::vector<std::shared_ptr<User>> users;
+		users.reserve(matches.size());
+		for (const UserSummary *summary : matches)
+		{
+			if (auto user = getUserById(summary->id))
+			{
+				users.push_back(user);
+			}
+		}
+		return users;
+	}
+
+	// Retrieve a user record by full name; when several users share the name the oldest account is returned
+	std::shared_ptr<User> getUserByName(const std::string &fullName)
+	{
+		auto users = getUsersByName(fullName);
+		return users.empty() ? nullptr : users.front();
+	}
+
+	// Delete a user record by ID (removes from memory and file system); returns false if no user has
+	// the ID, leaving the caller to report it. The role is known from the user's summary, so only that
+	// role's record file is removed.
+	bool deleteUserById(const std::string &userId)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		// Every stored user is known in memory (loaded or only summarized), so an unknown ID has no
+		// record file to delete and the filesystem is not probed for it
+		if (summaries.count(userId) == 0)
+		{
+			return false;
+		}
+
+		DeleteQueue::Removal removal = forgetUser(userId);
+		if (storageMode == StorageMode::Log)
+		{
+			return true;
+		}
+
+		// Hand the file to the background thread, or remove it right away. The user is known to exist,
+		// so a missing file (a create still queued when it was discarded) is not reported.
+		if (deleteQueue.isOpen())
+		{
+			deleteQueue.push({removal});
+		}
+		else
+		{
+			DeleteQueue::removeAll({removal});
+		}
+		return true;
+	}
+
+	// Delete several users at once; unknown IDs are skipped. Returns the number of users deleted.
+	// In files mode each record directory is synced once for the whole batch instead of once per file.
+	int deleteUsersById(const std::vector<std::string> &userIds)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		std::vector<DeleteQueue::Removal> removals;
+		for (const std::string &userId : userIds)
+		{
+			if (summaries.count(userId) != 0)
+			{
+				removals.push_back(forgetUser(userId));
+			}
+		}
+		if (storageMode == StorageMode::Log)
+		{
+			return static_cast<int>(removals.size());
+		}
+
+		if (deleteQueue.isOpen())
+		{
+			deleteQueue.push(removals);
+		}
+		else
+		{
+			DeleteQueue::removeAll(removals);
+		}
+		return static_cast<int>(removals.size());
+	}
+
+	// Update a user's record based on user ID, field name, and new value
+	void updateUser(const std::string &userId, const std::string &fieldName, const std::string &newValue)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		// Retrieve user object from ID
+		auto user = getUserById(userId);
+		if (!user)
+		{
+			std::cerr << "User with ID " << userId << " not found.\n";
+			return;
+		}
+
+		// A username can only be changed to one no other account uses
+		if (fieldName == "username" && isUsernameTaken(newValue, userId))
+		{
+			std::cerr << "User with username " << newValue << " already exists.\n";
+			return;
+		}
+
+		// Apply the change in memory, then persist it
+		if (applyFieldUpdate(user, fieldName, newValue))
+		{
+			indexUser(user);
+			persist(user, json{{"op", "update"}, {"id", userId}, {"field", fieldName}, {"value", newValue}});
+			cacheUser(user);
+		}
+	}
+
+	// Apply several field changes to a user as one update that is persisted once.
+	// If any field is not valid for the role, a value cannot be parsed or the new username is taken,
+	// no change is applied. Returns whether the update was applied.
+	bool updateUser(const std::string &userId, const std::vector<std::pair<std::string, std::string>> &changes)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		auto user = getUserById(userId);
+		if (!user)
+		{
+			std::cerr << "User with ID " << userId << " not found.\n";
+			return false;
+		}
+		if (changes.empty())
+		{
+			return true;
+		}
+
+		// Try every change on a blank user of the same role first, so that a rejected change leaves the user untouched
+		std::shared_ptr<User> scratch;
+		if (user->role == Role::Admin)
+		{
+			scratch = std::make_shared<Admin>();
+		}
+		else
+		{
+			scratch = std::make_shared<Patient>();
+		}
+		scratch->role = user->role;
+
+		json fields = json::object();
+		for (const auto &[fieldName, newValue] : changes)
+		{
+			if (fieldName == "username" && isUsernameTaken(newValue, userId))
+			{
+				std::cerr << "User with username " << newValue << " already exists.\n";
+				return false;
+			}
+			try
+			{
+				if (!applyFieldUpdate(scratch, fieldName, newValue))
+				{
+					return false;
+				}
+			}
+			catch (const std::exception &)
+			{
+				std::cerr << "Invalid value '" << newValue << "' for field '" << fieldName << "'.\n";
+				return false;
+			}
+			fields[fieldName] = newValue;
+		}
+
+		// Every change is known to apply; apply them all, then index and persist the user once
+		for (const auto &[fieldName, newValue] : changes)
+		{
+			applyFieldUpdate(user, fieldName, newValue);
+		}
+		indexUser(user);
+		persist(user, json{{"op", "update-fields"}, {"id", userId}, {"fields", fields}});
+		cacheUser(user);
+		return true;
+	}
+
+	// Record a new admission for a patient at the current time and persist it
+	void addAdmission(const std::shared_ptr<Patient> &patient, Admissions::Department dept)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		std::string dateTime = patient->addAdmission(dept);
+		indexUser(patient);
+		persist(patient, json{{"op", "add-admission"}, {"id", patient->getId()}, {"department", Admissions::departmentToString(dept)}, {"dateTime", dateTime}});
+		cacheUser(patient);
+	}
+
+	// Remove an admission from a patient and persist the change
+	void deleteAdmission(const std::shared_ptr<Patient> &patient, Admissions::Department dept, const std::string &dateTime)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		if (patient->deleteAdmission(dept, dateTime))
+		{
+			indexUser(patient);
+			persist(patient, json{{"op", "delete-admission"}, {"id", patient->getId()}, {"department", Admissions::departmentToString(dept)}, {"dateTime", dateTime}});
+			cacheUser(patient);
+		}
+	}
+
+	// Commit any buffered change records, queued and staged record writes and pending file removals to disk.
+	// Returns false if the change log could not be committed, or if it holds records but is not open.
+	// Called by EventManager::exit(), which also runs on SIGINT.
+	bool flush()
+	{
+		bool committed = recordLog.isOpen() ? recordLog.flush() : !recordLog.hasPending();
+		recordWriter.drain();
+		RecordSync::getInstance().flush();
+		deleteQueue.drain();
+		return committed;
+	}
+
+	// Write a checkpoint now instead of waiting for the background interval (used by --bench-startup)
+	void writeCheckpoint()
+	{
+		checkpoint();
+	}
+
+	// Validate user credentials and check if the user is an Admin
+	bool validateUser(const std::string &username, const std::string &password)
+	{
+		auto user = getUserByUsername(username);
+
+		// Ensure the user exists, is an Admin, and the password matches
+		if (user && user->getRole() == Role::Admin && user->getPassword() == password)
+		{
+			setCurrentUser(user); // Set the current user
+			return true;
+		}
+		return false;
+	}
+
+	// Number of stored Admin users (maintained on every create and delete, no disk access)
+	int getAdminCount()
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		return adminCount;
+	}
+
+	// Number of stored Patient users (maintained on every create and delete, no disk access)
+	int getPatientCount()
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		return patientCount;
+	}
+
+	// Number of admissions recorded in a department over all patients
+	int getAdmissionCount(Admissions::Department dept)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		auto it = admissionCounts.find(dept);
+		return it == admissionCounts.end() ? 0 : it->second;
+	}
+
+	// Hit, miss and eviction counters of the lazy-mode patient cache, for tuning HMS_CACHE_USERS/HMS_CACHE_MB
+	UserCache::Stats getCacheStats()
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		return patientCache.getStats();
+	}
+
+	// Number of admissions recorded over all departments and patients
+	int getAdmissionCount()
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		int total = 0;
+		for (const auto &pair : admissionCounts)
+		{
+			total += pair.second;
+		}
+		return total;
+	}
+
+	// Set the current user
+	void setCurrentUser(std::shared_ptr<User> user)
+	{
+		currentUser = user;
+	}
+
+	// Get the current user
+	const std::shared_ptr<User> &getCurrentUser() const
+	{
+		return currentUser;
+	}
+
+	// Retrieve a list of Admins whose full name, ID or username contains the query
+	std::vector<std::pair<std::string, std::string>> getAdmins(const std::string &query)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		return searchUsers(adminSearch, query);
+	}
+
+	// Retrieve a list of Patients whose full name, ID or username contains the query
+	std::vector<std::pair<std::string, std::string>> getPatients(const std::string &query)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		return searchUsers(patientSearch, query);
+	}
+
+	// Run a search over the users of a role (admin or patient) whose pages are read through getPage
+	UserSearch search(Role role, const std::string &query)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		UserSearch res;
+		res.role = role;
+		res.query = query;
+		res.changeCount = changeCount;
+		res.everyone = SearchIndex::normalizeQuery(query).empty();
+		SearchIndex *index = searchIndexFor(role);
+		if (index && !res.everyone)
+		{
+			res.matches = index->match(query);
+		}
+		return res;
+	}
+
+	// Narrow an earlier search down to a query extending its query. Only its matches are checked,
+	// so this is much cheaper than a new search; a stale search is run again instead.
+	UserSearch refineSearch(const UserSearch &previous, const std::string &query)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		SearchIndex *index = searchIndexFor(previous.role);
+		if (!index || previous.everyone || !isCurrent(previous))
+		{
+			return search(previous.role, query);
+		}
+
+		UserSearch res;
+		res.role = previous.role;
+		res.query = query;
+		res.changeCount = previous.changeCount;
+		res.matches = index->refine(previous.matches, query);
+		return res;
+	}
+
+	// Check whether no user was added, changed or removed since a search ran
+	bool isCurrent(const UserSearch &results)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		return results.changeCount == changeCount;
+	}
+
+	// Read up to limit results of a search starting at offset, plus the total number of matches.
+	// Only the matches up to the end of the page are put in order; the search keeps that work for
+	// later pages. A stale search is run again first so the page never refers to removed users.
+	UserPage getPage(UserSearch &results, size_t offset, size_t limit)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		if (!isCurrent(results))
+		{
+			results = search(results.role, results.query);
+		}
+
+		UserPage res;
+		SearchIndex *index = searchIndexFor(results.role);
+		if (!index)
+		{
+			return res;
+		}
+
+		std::vector<const UserSummary *> page;
+		if (results.everyone)
+		{
+			res.total = index->size();
+			page = index->page(offset, limit);
+		}
+		else
+		{
+			res.total = results.matches.total;
+			page = index->page(results.matches, offset, limit);
+		}
+
+		res.records.reserve(page.size());
+		for (const UserSummary *summary : page)
+		{
+			res.records.push_back({summary->fullName, summary->id});
+		}
+		return res;
+	}
+
+	// Read one page of the users of a role matching a query without keeping the search around
+	UserPage getPage(Role role, const std::string &query, size_t offset, size_t limit)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		UserSearch results = search(role, query);
+		return getPage(results, offset, limit);
+	}
+
+	// Number of changes made to the stored users so far; cached search results are stale once it moves
+	std::uint64_t getChangeCount()
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		return changeCount;
+	}
+};
+
+#endif // USER_MANAGER_H
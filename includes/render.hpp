@@ -15,6 +15,8 @@
 #include <algorithm>     // For algorithms like sorting, searching, transformations
 #include <memory>        // For smart pointers and dynamic memory management
 #include <cmath>         // For mathematical functions (pow, sqrt, etc.)
+#include <array>         // For fixed-size lookup tables
+#include <cstdint>       // For fixed-width integer types
 
 // ncurses headers for terminal-based UI rendering (wide character support)
 #include <ncursesw/ncurses.h> // Main ncurses library for UI rendering
@@ -42,6 +44,7 @@
 // Project-specific headers
 #include "admissions.hpp"  // Handles hospital department admissions
 #include "UserManager.hpp" // Manages user accounts and authentication
+#include "AdmissionLog.hpp" // Time-ordered admissions shown on the profile screen
 #include "utils.hpp"       // Utility functions for general-purpose operations
 
 // Forward declarations to reduce dependencies
@@ -106,113 +109,196 @@ struct Controls
         "[+] (Tab) - (Switch filters)",
         "[+] (PgDn) - (Next Page)",
         "[+] (PgUp) - (Prev Page)",
+        "[+] (Ctrl + G) - (Go to date)",
         "[+] (+) - (Add record)"}; // Control instructions
 };
 
-// Struct representing a user profile
-struct Profile
+// Struct representing the virtualized list of a patient's admissions, newest first.
+// The search keeps the log positions of the matching admissions, refining the last step when the query
+// is extended and returning to an earlier one on backspace; only the rows inside the window are formatted.
+struct AdmissionList
 {
-    std::shared_ptr<User> user; // Pointer to associated user data
-    Screen prevScreen;          // Tracks the previous screen visited
-
-    std::vector<std::string> patientSubheaderArr = {
-        "Account Information",
-        "Admissions"}; // Subsections under the profile page
+    // Positions in the log of the admissions matching a query, oldest first
+    struct Step
+    {
+        std::string query;
+        std::vector<std::uint32_t> positions;
+    };
 
-    std::vector<std::pair<std::string, std::string>> fieldValues; // Stores field name-value pairs
+    const AdmissionLog *log = nullptr; // Admissions being listed
+    std::vector<Step> searchSteps;     // Searches for the queries typed so far, shortest first
+    static constexpr size_t maxSearchSteps = 32; // Oldest steps are dropped beyond this
 
-    std::string searchQuery = ""; // Search term for filtering records
+    int top = 0;          // Row shown at the top of the window (row 0 is the newest match)
+    int visibleRows = 10; // Rows that fit in the window
 
-    // 2D list matrix (rows represent records)
-    std::vector<std::vector<std::string>> listMatrix;
+    // Starts listing a log, forgetting earlier searches
+    void open(const AdmissionLog &admissions)
+    {
+        log = &admissions;
+        searchSteps.clear();
+        top = 0;
+    }
 
-    int currentPage = 0;  // Current page number
-    int pageSize = 10;    // Number of records displayed per page
-    int totalPages = 0;   // Total number of pages
-    int selectedRow = -1; // Currently selected row (-1 means none)
-    int selectedCol = 2;  // Default column selection
+    // Forgets the searches after the log changed (positions past a deleted admission have moved)
+    void invalidate()
+    {
+        searchSteps.clear();
+    }
 
-    // Resets profile-related attributes
+    // Resets the list to its initial state
     void reset()
     {
-        currentPage = 0;
-        searchQuery.clear();
-        selectedRow = -1;
-        selectedCol = 2;
-        fieldValues.clear();
+        log = nullptr;
+        searchSteps.clear();
+        top = 0;
     }
 
-    // Generates list matrix from admission records
-    void generateListMatrix(const std::map<Admissions::Department, std::vector<std::string>> &records)
+    // Checks whether an admission matches a lowercased query; departments are matched once per search
+    // and dates are only formatted when the query could be part of a date
+    static bool matches(const AdmissionLog &admissions, size_t position, const std::string &query, bool dateQuery,
+                        std::array<signed char, 256> &deptMatches)
     {
-        std::vector<std::vector<std::string>> listMatrixTmp;
+        Admissions::Department dept = admissions.department(position);
+        signed char &deptMatch = deptMatches[static_cast<std::uint8_t>(dept)];
+        if (deptMatch < 0)
+        {
+            deptMatch = toLower(Admissions::departmentToString(dept)).find(query) != std::string::npos;
+        }
+        return deptMatch || (dateQuery && admissions.dateTime(position).find(query) != std::string::npos);
+    }
+
+    // Returns the search for a query, refining or reusing the steps typed so far (see Database::currentSearch)
+    const Step &search(const std::string &rawQuery)
+    {
+        std::string query = rawQuery.empty() ? "" : toLower(trim(rawQuery));
+
+        while (!searchSteps.empty() && query.compare(0, searchSteps.back().query.size(), searchSteps.back().query) != 0)
+        {
+            searchSteps.pop_back();
+        }
+        if (!searchSteps.empty() && searchSteps.back().query == query)
+        {
+            return searchSteps.back();
+        }
 
-        listMatrix.clear();
-        for (const auto &record : records) // Iterate over departments
+        Step step{query, {}};
+        bool dateQuery = query.find_first_not_of("0123456789-: ") == std::string::npos;
+        std::array<signed char, 256> deptMatches;
+        deptMatches.fill(-1);
+        if (!searchSteps.empty())
+        {
+            // A longer query only ever matches a subset of what a prefix of it matched
+            for (std::uint32_t position : searchSteps.back().positions)
+            {
+                if (matches(*log, position, query, dateQuery, deptMatches))
+                    step.positions.push_back(position);
+            }
+        }
+        else
         {
-            for (const auto &dateTime : record.second) // Iterate over admission dates
+            for (size_t position = 0; position < log->size(); position++)
             {
-                listMatrixTmp.push_back({Admissions::departmentToString(record.first),
-                                         dateTime,
-                                         "[Delete]"}); // Represents an admission entry
+                if (query.empty() || matches(*log, position, query, dateQuery, deptMatches))
+                    step.positions.push_back(static_cast<std::uint32_t>(position));
             }
         }
-        // Sort by date time of subarray dateTime strings in lexicographical order (descending AKA newest first)
-        std::sort(listMatrixTmp.begin(), listMatrixTmp.end(), [](const std::vector<std::string> &a, const std::vector<std::string> &b)
-                  { return std::greater<std::string>()(a[1], b[1]); });
 
-        // Repopulate listMatrix after correctly ordering records by latest admission date
-        for (const auto &record : listMatrixTmp)
+        searchSteps.push_back(std::move(step));
+        if (searchSteps.size() > maxSearchSteps)
         {
-            listMatrix.push_back(record);
+            searchSteps.erase(searchSteps.begin());
         }
-        totalPages = listMatrix.empty() ? 0 : (listMatrix.size() - 1) / pageSize + 1;
+        return searchSteps.back();
     }
 
-    // Retrieves the current page of records
-    std::vector<std::vector<std::string>> getCurrentPage()
+    // Number of rows matching the query
+    int size(const std::string &query)
     {
-        int startIndex = currentPage * pageSize;
-        int endIndex = std::min(startIndex + pageSize, static_cast<int>(listMatrix.size()));
-        std::vector<std::vector<std::string>> res;
+        return static_cast<int>(search(query).positions.size());
+    }
 
-        for (int i = startIndex; i < endIndex; i++)
+    // Log position of a row (rows count back from the newest match)
+    size_t position(const std::string &query, int row)
+    {
+        const std::vector<std::uint32_t> &positions = search(query).positions;
+        return positions[positions.size() - 1 - row];
+    }
+
+    // Moves the window by a number of rows, keeping it within the list
+    void scrollBy(const std::string &query, int rows)
+    {
+        top = std::max(0, std::min(top + rows, size(query) - visibleRows));
+    }
+
+    // Rows inside the window: department, admission date and the delete button
+    std::vector<std::vector<std::string>> visible(const std::string &query)
+    {
+        scrollBy(query, 0); // The list may have shrunk since the window was placed
+        std::vector<std::vector<std::string>> res;
+        int end = std::min(top + visibleRows, size(query));
+        for (int row = top; row < end; row++)
         {
-            res.push_back(listMatrix[i]);
+            size_t pos = position(query, row);
+            res.push_back({Admissions::departmentToString(log->department(pos)), log->dateTime(pos), "[Delete]"});
         }
         return res;
     }
 
-    // Performs a search on admission records
-    std::map<Admissions::Department, std::vector<std::string>> search(const std::string &query, const std::map<Admissions::Department, std::vector<std::string>> &records)
+    // Moves the window to the newest matching admission made on or before the given time and returns
+    // its row inside the window, or -1 when nothing matches
+    int jumpTo(const std::string &query, AdmissionLog::Time time)
     {
-        std::string filteredQuery = query.empty() ? "" : toLower(trim(query));
-        std::map<Admissions::Department, std::vector<std::string>> res;
+        const std::vector<std::uint32_t> &positions = search(query).positions;
+        if (positions.empty())
+            return -1;
 
-        for (const auto &record : records)
-        {
-            std::vector<std::string> matchedDates;
+        // Matches are ordered by time, so count those up to the time and step back from the newest
+        size_t upTo = std::upper_bound(positions.begin(), positions.end(), time, [this](AdmissionLog::Time t, std::uint32_t pos)
+                                       { return t < log->time(pos); }) -
+                      positions.begin();
+        int row = upTo == 0 ? static_cast<int>(positions.size()) - 1 : static_cast<int>(positions.size() - upTo);
+        top = row;
+        scrollBy(query, 0);
+        return row - top;
+    }
+};
 
-            if (filteredQuery.empty() || toLower(Admissions::departmentToString(record.first)).find(filteredQuery) != std::string::npos)
-            {
-                matchedDates = record.second;
-            }
-            else
-            {
-                for (const auto &dateTime : record.second)
-                {
-                    if (toLower(dateTime).find(filteredQuery) != std::string::npos)
-                    {
-                        matchedDates.push_back(dateTime);
-                    }
-                }
-            }
-            if (!matchedDates.empty())
-            {
-                res[record.first] = matchedDates;
-            }
-        }
-        return res;
+// Struct representing a user profile
+struct Profile
+{
+    std::shared_ptr<User> user; // Pointer to associated user data
+    Screen prevScreen;          // Tracks the previous screen visited
+
+    std::vector<std::string> patientSubheaderArr = {
+        "Account Information",
+        "Admissions"}; // Subsections under the profile page
+
+    std::vector<std::pair<std::string, std::string>> fieldValues; // Stores field name-value pairs
+
+    std::string searchQuery = ""; // Search term for filtering records
+
+    // 2D list matrix (rows represent records)
+    std::vector<std::vector<std::string>> listMatrix;
+
+    AdmissionList admissionList; // Admissions matching the search query, formatted a window at a time
+
+    std::string jumpQuery = ""; // Date typed into the go-to-date bar
+    bool jumping = false;       // The go-to-date bar replaces the search bar
+
+    int selectedRow = -1; // Currently selected row (-1 means none)
+    int selectedCol = 2;  // Default column selection
+
+    // Resets profile-related attributes
+    void reset()
+    {
+        searchQuery.clear();
+        admissionList.reset();
+        jumpQuery.clear();
+        jumping = false;
+        selectedRow = -1;
+        selectedCol = 2;
+        fieldValues.clear();
     }
 
     // Singleton Implementation
@@ -541,18 +627,21 @@ struct Database
     std::string searchQuery = "";           // Stores the current search query
     Filter currentFilter = Filter::patient; // Default filter is set to "patient"
 
-    // Matrix structure to store records (each row represents a record)
-    std::vector<std::vector<std::string>> listMatrixPatient, listMatrixAdmin, listMatrixCurrent;
+    // Rows of the page on screen: name, action buttons and user ID
+    std::vector<std::vector<std::string>> listMatrixCurrent;
+
+    int currentPage = 0;  // Current page number for pagination
+    int pageSize = 10;    // Number of records displayed per page
+    int totalPages = 0;   // Total pages of records matching the search
+    int selectedRow = -1; // Currently selected row index (-1 means no selection)
+    int selectedCol = 1;  // Currently selected column index
 
-    // Stores raw patient and admin records (pair of ID and other info)
-    std::vector<std::pair<std::string, std::string>> patientRecords, adminRecords;
+    std::string notice = ""; // Outcome of the last action that failed, shown until the next key
 
-    int currentPage = 0;       // Current page number for pagination
-    int pageSize = 10;         // Number of records displayed per page
-    int totalPagesAdmin = 0;   // Total pages for admin records
-    int totalPagesPatient = 0; // Total pages for patient records
-    int selectedRow = -1;      // Currently selected row index (-1 means no selection)
-    int selectedCol = 1;       // Currently selected column index
+    // Searches for the queries typed so far, shortest first, so that a longer query refines the
+    // last one and backspace returns to earlier ones without searching again
+    std::vector<UserSearch> searchSteps;
+    static constexpr size_t maxSearchSteps = 32; // Oldest steps are dropped beyond this
 
     // Function to reset the database filters and selection
     void reset()
@@ -562,67 +651,77 @@ struct Database
         searchQuery = "";
         selectedRow = -1;
         selectedCol = 1;
+        notice = "";
+        searchSteps.clear();
     }
 
-    // Function to generate the patient record matrix with action buttons
-    void generateListMatrixPatient(const std::vector<std::pair<std::string, std::string>> &records)
-    {
-        listMatrixPatient.clear();
-        for (const auto &record : records)
-        {
-            listMatrixPatient.push_back({record.first, "[View]", "[Update]", "[Delete]", record.second});
-        }
-        totalPagesPatient = listMatrixPatient.empty() ? 0 : (listMatrixPatient.size() - 1) / pageSize + 1;
-    }
-
-    // Function to generate the admin record matrix with action buttons
-    void generateListMatrixAdmin(const std::vector<std::pair<std::string, std::string>> &records)
+    // Function to get the search for searchQuery and the current filter.
+    // Steps that no longer lead to the query (another filter, changed users, or a query that is not
+    // a prefix of the current one) are discarded; the longest remaining step is reused when it is the
+    // same query and refined when the query extends it. Only without such a step is a new search run.
+    UserSearch &currentSearch()
     {
         UserManager &userManager = UserManager::getInstance();
-        auto currentUser = userManager.getCurrentUser();
+        Role role = currentFilter == Filter::patient ? Role::Patient : Role::Admin;
 
-        listMatrixAdmin.clear();
-        for (const auto &record : records)
+        while (!searchSteps.empty())
         {
-            if (record.second == currentUser->getId())
+            const UserSearch &last = searchSteps.back();
+            if (last.role != role || !userManager.isCurrent(last))
+            {
+                searchSteps.clear();
+            }
+            else if (searchQuery.compare(0, last.query.size(), last.query) != 0)
             {
-                listMatrixAdmin.push_back({record.first + " (me)", "[View]", "[Update]", "[Delete]", record.second});
+                searchSteps.pop_back();
             }
             else
             {
-                listMatrixAdmin.push_back({record.first, "[View]", "[Update]", "[Delete]", record.second});
+                break;
             }
         }
-        totalPagesAdmin = listMatrixAdmin.empty() ? 0 : (listMatrixAdmin.size() - 1) / pageSize + 1;
-    }
 
-    // Function to return the current page of admin records
-    std::vector<std::vector<std::string>> getCurrentPageAdmin()
-    {
-        int startIndex = currentPage * pageSize;
-        int endIndex = std::min(startIndex + pageSize, static_cast<int>(listMatrixAdmin.size()));
-        std::vector<std::vector<std::string>> res;
+        if (!searchSteps.empty() && searchSteps.back().query == searchQuery)
+        {
+            return searchSteps.back();
+        }
 
-        for (int i = startIndex; i < endIndex; i++)
+        if (!searchSteps.empty())
         {
-            res.push_back(listMatrixAdmin[i]);
+            searchSteps.push_back(userManager.refineSearch(searchSteps.back(), searchQuery));
         }
-        return res;
+        else
+        {
+            searchSteps.push_back(userManager.search(role, searchQuery));
+        }
+        if (searchSteps.size() > maxSearchSteps)
+        {
+            searchSteps.erase(searchSteps.begin());
+        }
+        return searchSteps.back();
     }
 
-    // Function to return the current page of patient records
-    std::vector<std::vector<std::string>> getCurrentPagePatient()
+    // Function to load the current page of matching records with action buttons.
+    // Only this page is read from the UserManager; a page past the end moves back to the last page.
+    void loadPage()
     {
-        int startIndex = currentPage * pageSize;
-        int endIndex = std::min(startIndex + pageSize, static_cast<int>(listMatrixPatient.size()));
+        UserManager &userManager = UserManager::getInstance();
+        UserPage page = userManager.getPage(currentSearch(), currentPage * pageSize, pageSize);
 
-        std::vector<std::vector<std::string>> res;
+        totalPages = page.total == 0 ? 0 : (static_cast<int>(page.total) - 1) / pageSize + 1;
+        if (currentPage > 0 && currentPage >= totalPages)
+        {
+            currentPage = std::max(0, totalPages - 1);
+            page = userManager.getPage(currentSearch(), currentPage * pageSize, pageSize);
+        }
 
-        for (int i = startIndex; i < endIndex; i++)
+        std::string currentUserId = userManager.getCurrentUser() ? userManager.getCurrentUser()->getId() : "";
+        listMatrixCurrent.clear();
+        for (const auto &record : page.records)
         {
-            res.push_back(listMatrixPatient[i]);
+            std::string name = currentFilter == Filter::admin && record.second == currentUserId ? record.first + " (me)" : record.first;
+            listMatrixCurrent.push_back({name, "[View]", "[Update]", "[Delete]", record.second});
         }
-        return res;
     }
 
     // Singleton Implementation - Ensures only one instance of Database exists
@@ -658,24 +757,16 @@ struct UpdatePatient
         if (!patient)
             return;
 
-        fieldValues = {
-            {"username", {patient->username, patient->username}},
-            {"password", {patient->password, patient->password}},
-            {"fullName", {patient->fullName, patient->fullName}},
-            {"religion", {patient->religion, patient->religion}},
-            {"nationality", {patient->nationality, patient->nationality}},
-            {"identityCardNumber", {patient->identityCardNumber, patient->identityCardNumber}},
-            {"maritalStatus", {patient->maritalStatus, patient->maritalStatus}},
-            {"gender", {patient->gender, patient->gender}},
-            {"race", {patient->race, patient->race}},
-            {"contactNumber", {patient->contactNumber, patient->contactNumber}},
-            {"emergencyContactNumber", {patient->emergencyContactNumber, patient->emergencyContactNumber}},
-            {"emergencyContactName", {patient->emergencyContactName, patient->emergencyContactName}},
-            {"email", {patient->email, patient->email}},
-            {"address", {patient->address, patient->address}},
-            {"height", {patient->height, patient->height}},
-            {"weight", {patient->weight, patient->weight}},
-        };
+        // Every editable field of the patient record, as (previous, current) values
+        fieldValues.clear();
+        for (const auto &field : Patient::fieldTable())
+        {
+            if (field.editable)
+            {
+                std::string value = field.format(*patient);
+                fieldValues[std::string(field.name)] = {value, value};
+            }
+        }
     }
 
     // Updates a specific field with a new value
@@ -687,11 +778,11 @@ struct UpdatePatient
         }
     }
 
-    // Handles updating the patient's record in the UserManager
+    // Handles updating the patient's record in the UserManager (all changed fields in one update)
     void handleUpdatePatient(const std::string &userId)
     {
-        UserManager &userManager = UserManager::getInstance();
-        auto patient = std::dynamic_pointer_cast<Patient>(userManager.getUserById(userId));
+        std::vector<std::pair<std::string, std::string>> changes;
+        bool bodyChanged = false;
 
         for (const auto &entry : fieldValues)
         {
@@ -703,19 +794,25 @@ struct UpdatePatient
             {
                 if (fieldName == "identityCardNumber") // If IC number changes, recalculate age
                 {
-                    int newAge = calculateAge(curr);
-                    userManager.updateUser(userId, "age", std::to_string(newAge));
+                    changes.emplace_back("age", std::to_string(calculateAge(curr)));
                 }
 
                 if (fieldName == "height" || fieldName == "weight") // If height or weight changes, recalculate BMI
                 {
-                    double newBMI = calculateBMI(fieldValues["weight"].second, fieldValues["height"].second);
-                    userManager.updateUser(userId, "bmi", std::to_string(newBMI));
+                    bodyChanged = true;
                 }
 
-                userManager.updateUser(userId, fieldName, curr); // Update field in database
+                changes.emplace_back(fieldName, curr);
             }
         }
+
+        if (bodyChanged)
+        {
+            double newBMI = calculateBMI(fieldValues["weight"].second, fieldValues["height"].second);
+            changes.emplace_back("bmi", std::to_string(newBMI));
+        }
+
+        UserManager::getInstance().updateUser(userId, changes); // Applied and saved once
     }
 
     // Singleton Implementation - Ensures only one instance exists
@@ -751,13 +848,13 @@ struct UpdateAdmin
         if (!admin)
             return;
 
-        fieldValues = {
-            {"username", {admin->username, admin->username}},
-            {"password", {admin->password, admin->password}},
-            {"fullName", {admin->fullName, admin->fullName}},
-            {"email", {admin->email, admin->email}},
-            {"contactNumber", {admin->contactNumber, admin->contactNumber}},
-        };
+        // Every field of the admin record, as (previous, current) values
+        fieldValues.clear();
+        for (const auto &field : Admin::fieldTable())
+        {
+            std::string value = field.format(*admin);
+            fieldValues[std::string(field.name)] = {value, value};
+        }
     }
 
     // Updates a specific field with a new value
@@ -769,10 +866,10 @@ struct UpdateAdmin
         }
     }
 
-    // Handles updating the admin's record in the UserManager
+    // Handles updating the admin's record in the UserManager (all changed fields in one update)
     void handleUpdateAdmin(const std::string &userId)
     {
-        UserManager &userManager = UserManager::getInstance();
+        std::vector<std::pair<std::string, std::string>> changes;
 
         for (const auto &entry : fieldValues)
         {
@@ -782,9 +879,11 @@ struct UpdateAdmin
 
             if (prev != curr) // Update only if there is a change
             {
-                userManager.updateUser(userId, fieldName, curr); // Update field in database
+                changes.emplace_back(fieldName, curr);
             }
         }
+
+        UserManager::getInstance().updateUser(userId, changes); // Applied and saved once
     }
 
     // Singleton Implementation - Ensures only one instance exists
@@ -812,6 +911,9 @@ void clearScreen();
 // Initializes color settings for the UI to improve readability and design.
 void initializeColors();
 
+// Waits for a key on the window; returns Esc (27) once an exit was requested from another thread (e.g. on SIGINT).
+int readKey(WINDOW *win);
+
 // Handles the exit logic, such as saving data or performing clean-up tasks when the program ends.
 void exitHandler(FORM *form, FIELD **fields, std::vector<WINDOW *> &windows);
 
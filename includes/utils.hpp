@@ -21,6 +21,13 @@
  */
 std::string formatTimestamp(std::chrono::system_clock::time_point timePoint);
 
+/**
+ * @brief Parses a timestamp string produced by formatTimestamp back into a time_point.
+ * @param timestamp The "%Y-%m-%d %H:%M:%S" formatted string.
+ * @return The corresponding time_point (throws std::invalid_argument on malformed input).
+ */
+std::chrono::system_clock::time_point parseTimestamp(const std::string &timestamp);
+
 /**
  * @brief Generates a universally unique identifier (UUID).
  * @return A string representing the generated UUID.
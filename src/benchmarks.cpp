@@ -0,0 +1,510 @@
+#include "benchmarks.hpp"
+#include "UserManager.hpp"
+#include "RecordFile.hpp"
+#include "SearchIndex.hpp"
+
+#include <deque>      // Keeps benchmark summaries at a stable address
+#include <functional> // Holds the serializer and parser of each benchmarked record format
+#include <cctype>     // Provides std::isdigit for checking the count
+#include <cerrno>     // Provides errno for detecting an out-of-range count
+#include <limits>     // Provides the largest count size_t holds
+#include <cstdlib>    // Provides std::strtoull for parsing the count
+
+// POSIX headers for running each benchmarked start in a fresh process
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h> // Provides mallinfo2 for measuring heap use in the admissions benchmark
+#endif
+
+/**
+ * @brief Times the Database screen search on a synthetic index and prints the results.
+ *
+ * Indexes count patients with generated UUIDs, as real records have, and names that all contain
+ * "patient", and prints the memory of the posting lists and bitmaps. It then reads the first page and the
+ * full ordering of that query, the first page of a query matching one patient in 64, and the first
+ * page of some one- and two-character queries. Finally removes up to 10000 of them one by one and
+ * reads a page halfway down the remaining users.
+ *
+ * @param count Number of synthetic patients to index.
+ */
+void benchmarkSearch(size_t count)
+{
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    std::deque<UserSummary> summaries; // Summaries must keep their address while indexed
+    SearchIndex index;
+    index.reserve(count);
+    std::chrono::system_clock::time_point base = std::chrono::system_clock::now();
+    for (size_t i = 0; i < count; ++i)
+    {
+        UserSummary summary;
+        summary.id = generateUUID();
+        summary.username = "user" + std::to_string(i);
+        summary.fullName = (i % 64 == 0 ? "Rare patient " : "Patient ") + std::to_string(i);
+        summary.role = Role::Patient;
+        summary.createdAt = base - std::chrono::seconds((i * 7919) % count); // Creation order unrelated to load order
+        summaries.push_back(summary);
+        index.add(summaries.back());
+    }
+
+    std::cout << "Index of " << count << " users: posting lists " << index.postingBytes() / (1024 * 1024) << " MiB, short-gram bitmaps "
+              << index.bitmapBytes() / (1024 * 1024) << " MiB" << std::endl;
+
+    Clock::time_point start = Clock::now();
+    index.page(0, 10);
+    std::cout << "Settle creation order of " << count << " users: " << elapsedMs(start) << " ms" << std::endl;
+
+    start = Clock::now();
+    SearchIndex::Matches matches = index.match("patient");
+    std::cout << "Match \"patient\" (" << matches.total << " matches): " << elapsedMs(start) << " ms" << std::endl;
+
+    start = Clock::now();
+    index.page(matches, 0, 10);
+    std::cout << "  First page: " << elapsedMs(start) << " ms" << std::endl;
+
+    start = Clock::now();
+    index.page(matches, 0, matches.total);
+    std::cout << "  Full order: " << elapsedMs(start) << " ms" << std::endl;
+
+    SearchIndex::Matches rare = index.match("rare");
+    start = Clock::now();
+    index.page(rare, 0, 10);
+    std::cout << "First page of \"rare\" (" << rare.total << " matches): " << elapsedMs(start) << " ms" << std::endl;
+
+    // One- and two-character queries, as typed at the start of a search
+    for (const char *query : {"a", "r", "7", "pa", "t1", "77", "_"})
+    {
+        start = Clock::now();
+        SearchIndex::Matches shortMatches = index.match(query);
+        index.page(shortMatches, 0, 10);
+        std::cout << "Match and first page of \"" << query << "\" (" << shortMatches.total << " matches): " << elapsedMs(start) << " ms" << std::endl;
+    }
+
+    // Removals scattered over the creation order, as when records are deleted one by one
+    size_t removals = std::min<size_t>(count, 10000);
+    start = Clock::now();
+    for (size_t i = 0; i < removals; ++i)
+    {
+        index.remove(summaries[(i * 7919) % count]);
+    }
+    std::cout << "Remove " << removals << " users: " << elapsedMs(start) << " ms" << std::endl;
+
+    start = Clock::now();
+    index.page(index.size() / 2, 10);
+    std::cout << "  Then a page halfway down: " << elapsedMs(start) << " ms" << std::endl;
+}
+
+/**
+ * @brief Times record file creation, listing and lookups in the flat and the sharded layout.
+ *
+ * Writes count small patient records in each layout under a scratch directory in the system temp
+ * directory, then lists them the way startup does and reads 10000 of them back by ID.
+ *
+ * @param count Number of synthetic records written per layout.
+ */
+void benchmarkLayout(size_t count)
+{
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    std::vector<std::string> ids(count);
+    for (std::string &id : ids)
+    {
+        id = generateUUID();
+    }
+    std::vector<size_t> lookups(std::min<size_t>(count, 10000));
+    for (size_t i = 0; i < lookups.size(); ++i)
+    {
+        lookups[i] = (i * 7919) % count;
+    }
+
+    RecordSync unsynced(Durability::None, 0);
+    std::filesystem::path previous = std::filesystem::current_path();
+    std::filesystem::path scratch = std::filesystem::temp_directory_path() / "hms-bench-layout";
+    for (RecordLayout layout : {RecordLayout::Flat, RecordLayout::Sharded})
+    {
+        std::filesystem::remove_all(scratch);
+        std::filesystem::create_directories(scratch);
+        std::filesystem::current_path(scratch);
+        std::cout << (layout == RecordLayout::Flat ? "Flat" : "Sharded") << " layout, " << count << " records:" << std::endl;
+
+        Clock::time_point start = Clock::now();
+        for (const std::string &id : ids)
+        {
+            unsynced.write(RecordFile::directory("patient", id, layout), RecordFile::path("patient", id, RecordFormat::Json, layout),
+                           json{{"id", id}, {"fullName", "Patient " + id}}.dump());
+        }
+        std::cout << "  Write: " << elapsedMs(start) << " ms" << std::endl;
+
+        start = Clock::now();
+        size_t listed = RecordFile::list("patient", layout).size();
+        std::cout << "  List (" << listed << " files): " << elapsedMs(start) << " ms" << std::endl;
+
+        start = Clock::now();
+        for (size_t i : lookups)
+        {
+            RecordFile::read(RecordFile::path("patient", ids[i], RecordFormat::Json, layout));
+        }
+        std::cout << "  Read " << lookups.size() << " by ID: " << elapsedMs(start) << " ms" << std::endl;
+
+        std::filesystem::current_path(previous);
+    }
+    std::filesystem::remove_all(scratch);
+}
+
+/**
+ * @brief Times record file saves under each durability policy.
+ *
+ * Saves count records, five saves per record in a row as when several fields of a form are
+ * edited, in a scratch directory under the system temp directory. The time includes syncing
+ * whatever is still staged at the end.
+ *
+ * @param count Number of saves per policy.
+ */
+void benchmarkDurability(size_t count)
+{
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::string> ids(std::max<size_t>(1, count / 5));
+    for (std::string &id : ids)
+    {
+        id = generateUUID();
+    }
+
+    std::filesystem::path previous = std::filesystem::current_path();
+    std::filesystem::path scratch = std::filesystem::temp_directory_path() / "hms-bench-durability";
+    for (Durability durability : {Durability::Sync, Durability::Group, Durability::None})
+    {
+        std::filesystem::remove_all(scratch);
+        std::filesystem::create_directories(scratch / "db" / "patient");
+        std::filesystem::current_path(scratch);
+
+        Clock::time_point start = Clock::now();
+        {
+            RecordSync sync(durability, Config::getInstance().groupCommitMs);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const std::string &id = ids[(i / 5) % ids.size()];
+                sync.write("db/patient", RecordFile::path("patient", id, RecordFormat::Json, RecordLayout::Flat),
+                           json{{"id", id}, {"fullName", "Patient " + id}, {"edit", i}}.dump());
+            }
+        } // Commits the staged writes left
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        const char *name = durability == Durability::Sync ? "sync" : durability == Durability::Group ? "group" : "none";
+        std::cout << name << ": " << count << " saves in " << seconds * 1000 << " ms (" << count / seconds << " saves/s)" << std::endl;
+        std::filesystem::current_path(previous);
+    }
+    std::filesystem::remove_all(scratch);
+}
+
+/**
+ * @brief Compares the size, serialization and parse time of patient records in each record format.
+ *
+ * Builds count synthetic patient records with three admissions each, then for pretty JSON,
+ * compact JSON, CBOR and MessagePack serializes all of them and parses them back, in memory.
+ *
+ * @param count Number of synthetic patient records.
+ */
+void benchmarkFormat(size_t count)
+{
+    using Clock = std::chrono::steady_clock;
+    std::vector<json> records;
+    records.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string n = std::to_string(i);
+        Patient patient("patient" + n, "password", 30, "Patient " + n, "None", "Malaysian", "900101-01-" + n, "Single",
+                        "Female", "Malay", "patient" + n + "@example.com", "0123456789", "0198765432", "Contact " + n,
+                        "Address " + n, 22.5, "170", "65", static_cast<Admissions::Department>(i % 21));
+        patient.addAdmission(Admissions::Department::Cardiology, "2024-01-15 09:30:00");
+        patient.addAdmission(Admissions::Department::Surgery, "2024-03-02 14:05:00");
+        records.push_back(patient);
+    }
+
+    struct Format
+    {
+        const char *name;
+        std::function<std::string(const json &)> serialize;
+        std::function<json(const std::string &)> parse;
+    };
+    const std::vector<Format> formats = {
+        {"pretty JSON", [](const json &j)
+         { return j.dump(4); }, [](const std::string &bytes)
+         { return json::parse(bytes); }},
+        {"compact JSON", [](const json &j)
+         { return j.dump(); }, [](const std::string &bytes)
+         { return json::parse(bytes); }},
+        {"CBOR", [](const json &j)
+         { return RecordFile::serialize(j, RecordFormat::Cbor); }, [](const std::string &bytes)
+         { return json::from_cbor(bytes); }},
+        {"MessagePack", [](const json &j)
+         { return RecordFile::serialize(j, RecordFormat::MessagePack); }, [](const std::string &bytes)
+         { return json::from_msgpack(bytes); }},
+    };
+
+    std::cout << count << " patient records:" << std::endl;
+    for (const Format &format : formats)
+    {
+        std::vector<std::string> encoded(count);
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            encoded[i] = format.serialize(records[i]);
+        }
+        double serializeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        size_t bytes = 0;
+        size_t roundTrips = 0; // Records that parse back equal to the original
+        start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            bytes += encoded[i].size();
+            roundTrips += format.parse(encoded[i]) == records[i];
+        }
+        double parseMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        std::cout << "  " << format.name << ": " << bytes / std::max<size_t>(count, 1) << " bytes/record, serialize "
+                  << serializeMs << " ms, parse " << parseMs << " ms"
+                  << (roundTrips == count ? "" : ", some records did not round-trip") << std::endl;
+    }
+}
+
+/**
+ * @brief Times starting the UserManager on synthetic patient records in each storage mode.
+ *
+ * Writes count patient records (one admission each) as JSON files under a scratch directory in the
+ * system temp directory. Every start then runs in a forked process, so each one begins with no
+ * singleton yet created: a full and a lazy load of the record files, a load from a checkpoint written
+ * by the previous start, and the first start in log mode (which imports the files), a later one
+ * (which replays the log) and one from the checkpoint that start wrote.
+ *
+ * @param count Number of synthetic patient records.
+ */
+void benchmarkStartup(size_t count)
+{
+    using Clock = std::chrono::steady_clock;
+    std::filesystem::path previous = std::filesystem::current_path();
+    std::filesystem::path scratch = std::filesystem::temp_directory_path() / "hms-bench-startup";
+    std::filesystem::remove_all(scratch);
+    std::filesystem::create_directories(scratch / "db" / "admin");
+    std::filesystem::create_directories(scratch / "db" / "patient");
+    std::filesystem::create_directories(scratch / "db" / "user");
+    std::filesystem::current_path(scratch);
+
+    Clock::time_point start = Clock::now();
+    {
+        RecordSync unsynced(Durability::None, 0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::string n = std::to_string(i);
+            Patient patient("patient" + n, "password", 30, "Patient " + n, "None", "Malaysian", "900101-01-" + n, "Single",
+                            "Female", "Malay", "patient" + n + "@example.com", "0123456789", "0198765432", "Contact " + n,
+                            "Address " + n, 22.5, "170", "65", static_cast<Admissions::Department>(i % 21));
+            unsynced.write("db/patient", RecordFile::path("patient", patient.getId(), RecordFormat::Json, RecordLayout::Flat),
+                           json(patient).dump());
+        }
+    }
+    std::cout << "Wrote " << count << " records in " << std::chrono::duration<double>(Clock::now() - start).count() << " s" << std::endl;
+
+    // Start the UserManager in a child process with the given options and report how long loading took
+    auto coldStart = [](const char *name, const std::vector<std::pair<const char *, const char *>> &options, bool checkpointAfter)
+    {
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            setenv("HMS_CHECKPOINT_SECONDS", "0", 1);
+            for (const auto &[option, value] : options)
+            {
+                setenv(option, value, 1);
+            }
+            Clock::time_point start = Clock::now();
+            UserManager &userManager = UserManager::getInstance();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            std::cout << name << ": " << userManager.getPatientCount() << " patients in " << seconds << " s" << std::endl;
+            if (checkpointAfter)
+            {
+                start = Clock::now();
+                userManager.writeCheckpoint();
+                std::cout << "  checkpoint written in " << std::chrono::duration<double>(Clock::now() - start).count() << " s" << std::endl;
+            }
+            std::cout.flush();
+            _exit(EXIT_SUCCESS); // Skip the shutdown work; nothing is left to write
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+    };
+
+    coldStart("Record files, full load", {}, false);
+    coldStart("Record files, lazy load", {{"HMS_LAZY_LOAD", "1"}}, true);
+    coldStart("Checkpoint, lazy load", {{"HMS_LAZY_LOAD", "1"}}, false);
+    Checkpoint::invalidate();
+    coldStart("Record files, full load", {}, true);
+    coldStart("Checkpoint, full load", {}, false);
+    coldStart("Log mode, first start (imports the files)", {{"HMS_STORAGE", "log"}}, false);
+    coldStart("Log mode, later start (replays the log)", {{"HMS_STORAGE", "log"}}, true);
+    coldStart("Log mode, start from a checkpoint", {{"HMS_STORAGE", "log"}}, false);
+
+    std::filesystem::current_path(previous);
+    std::filesystem::remove_all(scratch);
+}
+
+/**
+ * @brief Bytes of heap memory currently in use, or 0 where the C library cannot report it.
+ */
+size_t heapInUse()
+{
+#if defined(__GLIBC__)
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd; // Small blocks plus large blocks served by mmap
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Measures the memory and serialization time of one patient's admissions log.
+ *
+ * Records count admissions an hour apart, cycling through the departments, once as the former
+ * department -> date strings map and once as an AdmissionLog, and prints the heap bytes per admission
+ * of each. It then times writing the log as JSON and reading it back, and checks that both layouts
+ * serialize to the same JSON.
+ *
+ * @param count Number of admissions on the synthetic patient.
+ */
+void benchmarkAdmissions(size_t count)
+{
+    using Clock = std::chrono::steady_clock;
+    const int departments = static_cast<int>(Admissions::Department::PhysicalRehab) + 1;
+    const AdmissionLog::Time first = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()) - static_cast<AdmissionLog::Time>(count) * 3600;
+    auto department = [departments](size_t i)
+    { return static_cast<Admissions::Department>(i % departments); };
+
+    size_t before = heapInUse();
+    auto strings = std::make_unique<std::map<Admissions::Department, std::vector<std::string>>>();
+    for (size_t i = 0; i < count; ++i)
+    {
+        (*strings)[department(i)].push_back(AdmissionLog::format(first + static_cast<AdmissionLog::Time>(i) * 3600));
+    }
+    size_t stringBytes = heapInUse() - before;
+
+    before = heapInUse();
+    auto log = std::make_unique<AdmissionLog>();
+    for (size_t i = 0; i < count; ++i)
+    {
+        log->add(department(i), first + static_cast<AdmissionLog::Time>(i) * 3600);
+    }
+    size_t logBytes = heapInUse() - before;
+
+    if (before == 0)
+    {
+        std::cout << "Heap use cannot be measured on this platform; the log holds " << log->memoryBytes() << " bytes." << std::endl;
+    }
+    else
+    {
+        std::cout << "date strings: " << stringBytes << " bytes (" << static_cast<double>(stringBytes) / count << " bytes/admission)" << std::endl;
+        std::cout << "packed log:   " << logBytes << " bytes (" << static_cast<double>(logBytes) / count << " bytes/admission)" << std::endl;
+    }
+
+    json legacy = json::object();
+    for (const auto &[dept, dates] : *strings)
+    {
+        legacy[Admissions::departmentToString(dept)] = dates;
+    }
+
+    Clock::time_point start = Clock::now();
+    json j = log->toJson();
+    double toJsonMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    start = Clock::now();
+    AdmissionLog parsed = AdmissionLog::fromJson(j);
+    double fromJsonMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::cout << "to JSON: " << toJsonMs << " ms, from JSON: " << fromJsonMs << " ms, same JSON as the date strings: "
+              << (j == legacy && parsed.toJson() == legacy ? "yes" : "no") << std::endl;
+}
+
+/**
+ * @brief A benchmark selected on the command line, with the count it runs on by default.
+ */
+struct Benchmark
+{
+    const char *option;
+    size_t defaultCount;
+    void (*run)(size_t count);
+};
+
+/**
+ * @brief Every benchmark, by the option that selects it.
+ */
+static const Benchmark benchmarks[] = {
+    {"--bench-format", 20000, benchmarkFormat},
+    {"--bench-startup", 1000000, benchmarkStartup},
+    {"--bench-admissions", 100000, benchmarkAdmissions},
+    {"--bench-durability", 20000, benchmarkDurability},
+    {"--bench-layout", 200000, benchmarkLayout},
+    {"--bench-search", 1000000, benchmarkSearch},
+};
+
+/**
+ * @brief Looks up the benchmark an option selects.
+ * @return The benchmark, or nullptr if the option names none.
+ */
+static const Benchmark *findBenchmark(const std::string &option)
+{
+    for (const Benchmark &benchmark : benchmarks)
+    {
+        if (option == benchmark.option)
+            return &benchmark;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Parses a count argument: a whole number of at least 1, without sign or trailing text.
+ * @return false if the text is not such a number or does not fit in size_t.
+ */
+static bool parseCount(const char *text, size_t &count)
+{
+    if (!std::isdigit(static_cast<unsigned char>(text[0])))
+        return false;
+    errno = 0;
+    char *end = nullptr;
+    unsigned long long value = std::strtoull(text, &end, 10);
+    if (errno == ERANGE || *end != '\0' || value == 0 || value > std::numeric_limits<size_t>::max())
+        return false;
+    count = static_cast<size_t>(value);
+    return true;
+}
+
+bool isBenchmarkOption(const std::string &option)
+{
+    return findBenchmark(option) != nullptr;
+}
+
+int runBenchmark(const std::string &option, const char *countArg)
+{
+    const Benchmark *benchmark = findBenchmark(option);
+    if (!benchmark)
+    {
+        std::cerr << "Error: Unknown benchmark " << option << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    size_t count = benchmark->defaultCount;
+    if (countArg && !parseCount(countArg, count))
+    {
+        std::cerr << "Error: " << option << " expects a positive whole number as its count, not \"" << countArg << "\"" << std::endl;
+        return EXIT_FAILURE;
+    }
+    benchmark->run(count);
+    return EXIT_SUCCESS;
+}
@@ -1,42 +1,86 @@
 #include "UserManager.hpp"
 #include "EventManager.hpp"
+#include "RecordFile.hpp"
+#include "benchmarks.hpp"
 
-/**
- * @brief Atomic flag to prevent multiple cleanup executions.
- */
-std::atomic<bool> isCleaningUp{false};
+#include <thread>     // Runs the thread that waits for termination signals
+#include <csignal>    // Provides sigwait and pthread_sigmask for taking signals off the handler path
 
 /**
- * @brief Signal handler for handling termination signals (e.g., SIGINT).
- * 
- * @param signum The signal number received.
+ * @brief Waits for termination signals (e.g., SIGINT) and asks the UI thread to shut down.
+ *
+ * The signals are blocked in every thread and taken here with sigwait. This thread only sets the
+ * exit request: the UI thread notices it in readKey() and runs the flush, the ncurses teardown and
+ * std::exit itself, so nothing it is using is torn down underneath it.
+ *
+ * @param signals The blocked signals to wait for.
  */
-void signalHandler(int signum)
+void signalWaiter(sigset_t signals)
 {
-    // Prevent multiple executions of cleanup logic
-    if (isCleaningUp.load())
+    int signum = 0;
+    while (sigwait(&signals, &signum) == 0)
     {
-        return;
+        EventManager::requestExit();
     }
-    isCleaningUp.store(true);
-
-    // Get the singleton instance of EventManager and trigger cleanup
-    EventManager &eventManager = EventManager::getInstance();
-    eventManager.exit();
-
-    // Exit the application with the received signal number
-    exit(signum);
 }
 
 /**
  * @brief Main function to initialize and run the event-driven system.
  * 
+ * Passing --migrate-format rewrites every record file in the format selected by HMS_FORMAT
+ * and exits without starting the user interface; --migrate-layout likewise moves every record file
+ * into the layout selected by HMS_LAYOUT. Passing one of the --bench-* options (see benchmarks.hpp)
+ * runs that benchmark and exits.
+ * 
+ * @param argc Number of command-line arguments.
+ * @param argv Command-line arguments.
  * @return int Returns EXIT_SUCCESS on normal execution, EXIT_FAILURE on exceptions.
  */
-int main()
+int main(int argc, char *argv[])
 {
-    // Register signal handler for SIGINT (Ctrl + C)
-    signal(SIGINT, signalHandler);
+    if (argc > 1 && std::string(argv[1]) == "--migrate-format")
+    {
+        try
+        {
+            int converted = RecordFile::migrateAll(Config::getInstance().recordFormat);
+            std::cout << "Converted " << converted << " record file(s)." << std::endl;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--migrate-layout")
+    {
+        try
+        {
+            int moved = RecordFile::migrateLayout(Config::getInstance().recordLayout);
+            std::cout << "Moved " << moved << " record file(s)." << std::endl;
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (argc > 1 && isBenchmarkOption(argv[1]))
+    {
+        return runBenchmark(argv[1], argc > 2 ? argv[2] : nullptr);
+    }
+
+    // Hand SIGINT (Ctrl + C) and SIGTERM to the signal thread; blocked before any other thread
+    // starts so that every thread inherits the mask and only sigwait receives them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::thread(signalWaiter, signals).detach();
 
     try
     {
@@ -55,6 +55,21 @@ void printCentered(WINDOW *win, int startRow, const std::string &text)
     }
 }
 
+int readKey(WINDOW *win)
+{
+    // Wake up every 100 ms to check for an exit request, since a blocked read would not return until a key is pressed
+    wtimeout(win, 100);
+    int ch;
+    while ((ch = wgetch(win)) == ERR)
+    {
+        if (EventManager::isExitRequested())
+        {
+            return 27; // Exit like the Esc key, on this thread
+        }
+    }
+    return ch;
+}
+
 void exitHandler(FORM *form, FIELD **fields, std::vector<WINDOW *> &windows)
 {
     // Clean up form
@@ -413,7 +428,7 @@ void renderLoginScreen()
 
     // Main input loop
     int ch;
-    while ((ch = getch()) != '\n')
+    while ((ch = readKey(stdscr)) != '\n')
     {
         switch (ch)
         {
@@ -580,7 +595,7 @@ void renderRegistrationAccountPatientScreen()
 
     while (!done)
     {
-        while ((ch = getch()) != '\n') // Continue until Enter key is pressed
+        while ((ch = readKey(stdscr)) != '\n') // Continue until Enter key is pressed
         {
             driver_form(
                 ch,
@@ -607,6 +622,10 @@ void renderRegistrationAccountPatientScreen()
         {
             errorMessage = "Please fill all required fields";
         }
+        else if (UserManager::getInstance().isUsernameTaken(trim_whitespaces(field_buffer(fields[1], 0))))
+        {
+            errorMessage = "Username is already taken";
+        }
         else if (!validateEmail(trim_whitespaces(field_buffer(fields[5], 0))))
         {
             errorMessage = "Please enter a valid email";
@@ -761,7 +780,7 @@ void renderRegistrationPersonalPatientScreen()
     while (!done)
     {
         // Wait for input until 'Enter' is pressed
-        while ((ch = getch()) != '\n')
+        while ((ch = readKey(stdscr)) != '\n')
         {
             // Handle form navigation and other key inputs
             driver_form(
@@ -918,7 +937,7 @@ void renderRegistrationSelectionPatientScreen()
         wrefresh(win_form); // Refresh win_form to show the menus
 
         // Handle user input
-        int ch = wgetch(win_form);
+        int ch = readKey(win_form);
         switch (ch)
         {
         case KEY_UP: // Move up to previous menu
@@ -940,6 +959,12 @@ void renderRegistrationSelectionPatientScreen()
         case 10: // Enter key confirms selection and exits
             done = true;
             break;
+        case 27: // Escape key exits the application
+        {
+            std::vector<WINDOW *> windows = {win_body, win_form};
+            exitHandler(nullptr, nullptr, windows);
+            break;
+        }
         case 2: // Custom key for "Back"
             std::vector<WINDOW *> windows = {win_body, win_form};
             navigationHandler(nullptr, nullptr, windows, Screen::RegistrationPersonalPatientScreen);
@@ -1144,7 +1169,7 @@ void renderRegistrationScreenAdmin()
 
     while (!done)
     {
-        while ((ch = getch()) != '\n') // Wait for Enter key to submit form
+        while ((ch = readKey(stdscr)) != '\n') // Wait for Enter key to submit form
         {
             driver_form(
                 ch,
@@ -1169,6 +1194,10 @@ void renderRegistrationScreenAdmin()
         {
             errorMessage = "Please fill all required fields";
         }
+        else if (UserManager::getInstance().isUsernameTaken(trim_whitespaces(field_buffer(fields[1], 0))))
+        {
+            errorMessage = "Username is already taken";
+        }
         else if (!validateEmail(trim_whitespaces(field_buffer(fields[7], 0))))
         {
             errorMessage = "Please enter a valid email";
@@ -1260,10 +1289,14 @@ void renderDashboardScreen()
 
     std::string header = "Dashboard";                                                    // Set the header text for the screen.
     std::string currentlyLoggedUser = "Currently logged in as " + currentUser->username; // Display the logged-in user's name.
+    std::string recordCounts = "Patients: " + std::to_string(userManager.getPatientCount()) +
+                               " | Admins: " + std::to_string(userManager.getAdminCount()) +
+                               " | Admissions: " + std::to_string(userManager.getAdmissionCount()); // Live record counters.
 
     int baseline = 11;
     mvprintw(baseline, (COLS - header.length()) / 2, "%s", header.c_str());                               // Print header centered on screen.
     mvprintw(baseline + 2, (COLS - currentlyLoggedUser.length()) / 2, "%s", currentlyLoggedUser.c_str()); // Print the logged-in user's name.
+    mvprintw(baseline + 3, (COLS - recordCounts.length()) / 2, "%s", recordCounts.c_str());               // Print the record counters.
     refresh();                                                                                            // Refresh the screen to display the changes.
 
     // Define the size and position for the main window (win_body) that holds the menu.
@@ -1329,7 +1362,7 @@ void renderDashboardScreen()
         wrefresh(win_form); // Refresh win_form to show the updated menu options.
 
         // Handle user input.
-        int ch = wgetch(win_form); // Get user input.
+        int ch = readKey(win_form); // Get user input.
         switch (ch)
         {
         case KEY_UP: // If the user presses the UP key, move the selection up.
@@ -1426,28 +1459,10 @@ void handleDatabaseControls(WINDOW *win_form, WINDOW *win_body)
         if (currentUser->getId() == userId)
             break;
 
-        userManager.deleteUserById(userId);
-        // Refresh the list of records after deletion to reflect the changes.
-        if (db.currentFilter == Database::Filter::patient)
-        {
-            db.patientRecords = userManager.getPatients(db.searchQuery);
-            db.generateListMatrixPatient(db.patientRecords);
-        }
-        else
-        {
-            db.adminRecords = userManager.getAdmins(db.searchQuery);
-            db.generateListMatrixAdmin(db.adminRecords);
-        }
-
-        // Update the list displayed on the current page after the deletion.
-        db.listMatrixCurrent = db.currentFilter == Database::Filter::patient ? db.getCurrentPagePatient() : db.getCurrentPageAdmin();
-
-        // If the current page is empty after deletion, move to the previous page.
-        while (db.listMatrixCurrent.empty() && db.currentPage > 0)
-        {
-            db.currentPage--;
-            db.listMatrixCurrent = db.currentFilter == Database::Filter::patient ? db.getCurrentPagePatient() : db.getCurrentPageAdmin();
-        }
+        if (!userManager.deleteUserById(userId))
+            db.notice = "User could not be deleted: record not found";
+        // Refresh the current page after deletion (moving to the previous page if it is now empty).
+        db.loadPage();
 
         // Adjust the selected row to avoid it going out of bounds after deletion.
         if (db.selectedRow >= static_cast<int>(db.listMatrixCurrent.size()))
@@ -1466,7 +1481,6 @@ void handleDatabaseControls(WINDOW *win_form, WINDOW *win_body)
 void renderDatabaseScreen()
 {
     Color &colorScheme = Color::getInstance();             // Get the color scheme for UI elements.
-    UserManager &userManager = UserManager::getInstance(); // User manager to handle users and their records.
     Database &db = Database::getInstance();                // Database instance to manage and display records.
 
     renderHeader();      // Render the screen header.
@@ -1500,16 +1514,8 @@ void renderDatabaseScreen()
     box(win_form, 0, 0);                              // Draw a box around win_form.
     wrefresh(win_form);                               // Refresh win_form.
 
-    // Fetch patient and admin records based on the search query.
-    db.patientRecords = userManager.getPatients(db.searchQuery);
-    db.adminRecords = userManager.getAdmins(db.searchQuery);
-
-    // Generate the list matrix for the current records.
-    db.generateListMatrixPatient(db.patientRecords);
-    db.generateListMatrixAdmin(db.adminRecords);
-
-    // Set the list to display based on the current filter (patient/admin).
-    db.listMatrixCurrent = db.currentFilter == Database::Filter::patient ? db.getCurrentPagePatient() : db.getCurrentPageAdmin();
+    // Load the page of records to display for the current filter (patient/admin) and search query.
+    db.loadPage();
 
     std::vector<WINDOW *> windows = {win_body, win_form};
 
@@ -1572,6 +1578,10 @@ void renderDatabaseScreen()
             }
         }
 
+        // Show the outcome of a failed action on the last line of the form.
+        if (!db.notice.empty())
+            mvwprintw(win_form, inner_height - 2, (inner_width - db.notice.length()) / 2, "%s", db.notice.c_str());
+
         // Show cursor in the search bar if no row is selected, else hide it.
         if (db.selectedRow == -1)
         {
@@ -1585,7 +1595,8 @@ void renderDatabaseScreen()
 
         wrefresh(win_form); // Refresh the form window.
 
-        ch = wgetch(win_form); // Get user input.
+        ch = readKey(win_form); // Get user input.
+        db.notice = "";         // A notice lasts until the next key.
 
         if (db.selectedRow == -1) // If no row is selected, handle the search input.
         {
@@ -1600,19 +1611,8 @@ void renderDatabaseScreen()
                 db.searchQuery += static_cast<char>(ch); // Add the character to the search query.
             }
 
-            // Regenerate list based on the updated search query.
-            if (db.currentFilter == Database::Filter::patient)
-            {
-                db.patientRecords = userManager.getPatients(db.searchQuery);
-                db.generateListMatrixPatient(db.patientRecords);
-                db.listMatrixCurrent = db.getCurrentPagePatient();
-            }
-            else
-            {
-                db.adminRecords = userManager.getAdmins(db.searchQuery);
-                db.generateListMatrixAdmin(db.adminRecords);
-                db.listMatrixCurrent = db.getCurrentPageAdmin();
-            }
+            // Reload the page based on the updated search query (refining the previous results when possible).
+            db.loadPage();
         }
 
         // Handle input for navigation and switching filters.
@@ -1645,11 +1645,7 @@ void renderDatabaseScreen()
             db.currentFilter = (db.currentFilter == Database::Filter::patient) ? Database::Filter::admin : Database::Filter::patient;
             db.currentPage = 0;     // Reset page when switching filters.
             db.searchQuery.clear(); // Clear the search query.
-            db.patientRecords = userManager.getPatients("");
-            db.adminRecords = userManager.getAdmins("");
-            db.generateListMatrixPatient(db.patientRecords);
-            db.generateListMatrixAdmin(db.adminRecords);
-            db.listMatrixCurrent = db.currentFilter == Database::Filter::patient ? db.getCurrentPagePatient() : db.getCurrentPageAdmin();
+            db.loadPage();
             db.selectedRow = -1; // No row selected initially.
             db.selectedCol = 1;  // Default column selection.
             break;
@@ -1657,23 +1653,16 @@ void renderDatabaseScreen()
             if (db.currentPage > 0)
             {
                 db.currentPage--;
-                db.listMatrixCurrent = db.currentFilter == Database::Filter::patient ? db.getCurrentPagePatient() : db.getCurrentPageAdmin();
+                db.loadPage();
                 db.selectedRow = -1;
                 db.selectedCol = 1;
             }
             break;
         case KEY_NPAGE: // Handle page down action.
-            if (db.currentFilter == Database::Filter::patient && db.currentPage + 1 < db.totalPagesPatient)
+            if (db.currentPage + 1 < db.totalPages)
             {
                 db.currentPage++;
-                db.listMatrixCurrent = db.getCurrentPagePatient();
-                db.selectedRow = -1;
-                db.selectedCol = 1;
-            }
-            else if (db.currentFilter == Database::Filter::admin && db.currentPage + 1 < db.totalPagesAdmin)
-            {
-                db.currentPage++;
-                db.listMatrixCurrent = db.getCurrentPageAdmin();
+                db.loadPage();
                 db.selectedRow = -1;
                 db.selectedCol = 1;
             }
@@ -1749,9 +1738,8 @@ void renderProfileAdmissionsScreen()
     keypad(win_form, TRUE); // Enable special keys (e.g., arrow keys, Enter, etc.)
     curs_set(0);            // Hide the cursor
 
-    // Generate the list of admissions for the patient based on the current search query
-    p.generateListMatrix(p.search(p.searchQuery, patient->admissions));
-    p.listMatrix = p.getCurrentPage();
+    // List the patient's admissions; rows are formatted only when they are inside the window
+    p.admissionList.open(patient->admissions);
 
     std::vector<WINDOW *> windows = {win_body, win_form};
 
@@ -1775,11 +1763,27 @@ void renderProfileAdmissionsScreen()
         // Draw a horizontal line for separation
         mvwhline(win_form, 2, 2, ACS_HLINE, inner_width - 4);
 
-        // Render the search bar at the top of the form window
-        std::string searchText = "Search: " + p.searchQuery;
+        // Render the search bar (or the go-to-date bar) at the top of the form window
+        std::string searchText = p.jumping ? "Go to date (YYYY-MM-DD): " + p.jumpQuery : "Search: " + p.searchQuery;
         mvwprintw(win_form, 1, 2, "%s", searchText.c_str());
 
-        // Render the list of admissions for the current page
+        // Format the rows inside the window and keep the selection within them
+        p.listMatrix = p.admissionList.visible(p.searchQuery);
+        if (p.selectedRow >= static_cast<int>(p.listMatrix.size()))
+        {
+            p.selectedRow = static_cast<int>(p.listMatrix.size()) - 1;
+        }
+
+        // Render the position of the window in the list at the right of the search bar
+        if (!p.listMatrix.empty())
+        {
+            std::string rangeText = std::to_string(p.admissionList.top + 1) + "-" +
+                                    std::to_string(p.admissionList.top + static_cast<int>(p.listMatrix.size())) + " of " +
+                                    std::to_string(p.admissionList.size(p.searchQuery));
+            mvwprintw(win_form, 1, inner_width - 2 - rangeText.length(), "%s", rangeText.c_str());
+        }
+
+        // Render the admissions inside the window
         if (p.listMatrix.empty())
         {
             std::string emptyText = "No records found.";
@@ -1814,8 +1818,8 @@ void renderProfileAdmissionsScreen()
             }
         }
 
-        // If no row is selected, show the cursor in the search bar
-        if (p.selectedRow == -1)
+        // If no row is selected (or a date is being typed), show the cursor in the bar
+        if (p.selectedRow == -1 || p.jumping)
         {
             curs_set(1);                                 // Show the cursor
             wmove(win_form, 1, 2 + searchText.length()); // Move cursor to the end of the search query
@@ -1828,7 +1832,48 @@ void renderProfileAdmissionsScreen()
         wrefresh(win_form);
 
         // Get the user input (key press)
-        ch = wgetch(win_form);
+        ch = readKey(win_form);
+
+        // Handle input for the go-to-date bar; Enter moves the window to the newest admission on or before the date
+        if (p.jumping)
+        {
+            if (ch == KEY_BACKSPACE || ch == 127) // Handle backspace
+            {
+                if (!p.jumpQuery.empty())
+                    p.jumpQuery.pop_back();
+            }
+            else if (ch >= 32 && ch <= 126) // Handle printable characters
+            {
+                p.jumpQuery += static_cast<char>(ch);
+            }
+            else if (ch == '\n')
+            {
+                try
+                {
+                    std::string date = trim(p.jumpQuery);
+                    AdmissionLog::Time time = AdmissionLog::toTime(date.length() == 10 ? date + " 23:59:59" : date);
+                    p.selectedRow = p.admissionList.jumpTo(p.searchQuery, time);
+                    p.selectedCol = 1;
+                    p.jumping = false;
+                    p.jumpQuery.clear();
+                }
+                catch (const std::invalid_argument &)
+                {
+                    // Keep the bar open so that the date can be corrected
+                }
+            }
+            else if (ch == 7 || ch == 2) // Ctrl + G or Ctrl + B closes the bar
+            {
+                p.jumping = false;
+                p.jumpQuery.clear();
+            }
+            else if (ch == 27) // ESC to exit
+            {
+                exitHandler(nullptr, nullptr, windows);
+                done = true;
+            }
+            continue;
+        }
 
         // Handle input for search query (backspace and character input)
         if (p.selectedRow == -1)
@@ -1840,12 +1885,9 @@ void renderProfileAdmissionsScreen()
             }
             else if (ch >= 32 && ch <= 126) // Handle printable characters
             {
-                p.currentPage = 0;                      // Reset to the first page
+                p.admissionList.top = 0;                // Return to the newest admission
                 p.searchQuery += static_cast<char>(ch); // Add the character to the search query
             }
-            // Regenerate the list based on the updated search query
-            p.generateListMatrix(p.search(p.searchQuery, patient->admissions));
-            p.listMatrix = p.getCurrentPage();
         }
 
         // Handle input for navigation and actions (enter, arrow keys, etc.)
@@ -1855,54 +1897,42 @@ void renderProfileAdmissionsScreen()
             done = true;
             break;
         case '\n': // Enter key to delete an admission
-            if (p.listMatrix.empty())
+            if (p.selectedRow < 0 || p.listMatrix.empty())
                 break;
-            // Delete the selected admission
-            patient->deleteAdmission(Admissions::stringToDepartment(p.listMatrix[p.selectedRow][0]), p.listMatrix[p.selectedRow][1]);
-            // Regenerate the list after deletion
-            p.generateListMatrix(p.search(p.searchQuery, patient->admissions));
-            p.listMatrix = p.getCurrentPage();
-            while (p.listMatrix.empty() && p.currentPage > 0)
-            {
-                p.currentPage--;
-                p.listMatrix = p.getCurrentPage();
-            }
-            // Adjust selected row if necessary
-            if (p.selectedRow >= static_cast<int>(p.listMatrix.size()))
-            {
-                p.selectedRow = std::max(0, static_cast<int>(p.listMatrix.size()) - 1);
-            }
+            // Delete the selected admission; the search is run again as positions in the log have moved
+            UserManager::getInstance().deleteAdmission(patient, Admissions::stringToDepartment(p.listMatrix[p.selectedRow][0]), p.listMatrix[p.selectedRow][1]);
+            p.admissionList.invalidate();
             break;
-        case KEY_DOWN: // Down arrow key for navigation
-            if (p.selectedRow < static_cast<int>(p.listMatrix.size() - 1))
+        case KEY_DOWN: // Down arrow key: move the selection, scrolling by a line at the bottom of the window
+            if (p.selectedRow < static_cast<int>(p.listMatrix.size()) - 1)
                 p.selectedRow++;
+            else if (p.selectedRow >= 0)
+                p.admissionList.scrollBy(p.searchQuery, 1);
             break;
-        case KEY_UP: // Up arrow key for navigation
-            if (p.selectedRow > -1)
+        case KEY_UP: // Up arrow key: move the selection, scrolling by a line at the top of the window
+            if (p.selectedRow > 0)
                 p.selectedRow--;
+            else if (p.selectedRow == 0 && p.admissionList.top > 0)
+                p.admissionList.scrollBy(p.searchQuery, -1);
+            else if (p.selectedRow == 0)
+                p.selectedRow = -1;
+            break;
+        case 7: // Ctrl + G opens the go-to-date bar
+            p.jumping = true;
+            p.jumpQuery.clear();
             break;
         case 9: // Tab key (custom action)
             done = true;
             break;
-        case KEY_PPAGE: // Page Up key
-            if (p.currentPage > 0)
-            {
-                p.currentPage--;
-                p.generateListMatrix(p.search(p.searchQuery, patient->admissions));
-                p.listMatrix = p.getCurrentPage();
-                p.selectedRow = -1;
-                p.selectedCol = 1;
-            }
+        case KEY_PPAGE: // Page Up key: scroll the window up by its height
+            p.admissionList.scrollBy(p.searchQuery, -p.admissionList.visibleRows);
+            p.selectedRow = -1;
+            p.selectedCol = 1;
             break;
-        case KEY_NPAGE: // Page Down key
-            if (p.currentPage + 1 < p.totalPages)
-            {
-                p.currentPage++;
-                p.generateListMatrix(p.search(p.searchQuery, patient->admissions));
-                p.listMatrix = p.getCurrentPage();
-                p.selectedRow = -1;
-                p.selectedCol = 1;
-            }
+        case KEY_NPAGE: // Page Down key: scroll the window down by its height
+            p.admissionList.scrollBy(p.searchQuery, p.admissionList.visibleRows);
+            p.selectedRow = -1;
+            p.selectedCol = 1;
             break;
         case 27: // ESC to exit
             exitHandler(nullptr, nullptr, windows);
@@ -2019,7 +2049,7 @@ void renderProfileScreen()
         // Enter the input loop
         while (true)
         {
-            ch = getch(); // Get user input
+            ch = readKey(stdscr); // Get user input
 
             switch (ch)
             {
@@ -2102,7 +2132,7 @@ void renderProfileScreen()
         // Enter the input loop for admin profile
         while (true)
         {
-            ch = getch(); // Get user input
+            ch = readKey(stdscr); // Get user input
 
             if (ch == 2) // Handle 'Back' key (Ctrl+B)
             {
@@ -2238,7 +2268,7 @@ void renderAdmissionScreen()
         wrefresh(win_form);
 
         // Capture user input
-        ch = wgetch(win_form);
+        ch = readKey(win_form);
 
         // Handle input for search query updates (backspace and character entry)
         if (a.selectedRow == -1)
@@ -2313,7 +2343,7 @@ void renderAdmissionScreen()
     {
         Profile &p = Profile::getInstance();
         auto patient = std::dynamic_pointer_cast<Patient>(p.user);
-        patient->addAdmission(a.selectedDepartment);
+        UserManager::getInstance().addAdmission(patient, a.selectedDepartment);
     }
 
     // Reset the admission state and navigate back to the previous screen
@@ -2438,7 +2468,7 @@ void renderUpdateAccountPatientScreen()
     while (!done)
     {
         // Wait for user input until Enter key is pressed
-        while ((ch = getch()) != '\n')
+        while ((ch = readKey(stdscr)) != '\n')
         {
             driver_form(
                 ch,
@@ -2465,6 +2495,10 @@ void renderUpdateAccountPatientScreen()
         {
             errorMessage = "Please fill all required fields";
         }
+        else if (UserManager::getInstance().isUsernameTaken(trim_whitespaces(field_buffer(fields[1], 0)), u.user->getId()))
+        {
+            errorMessage = "Username is already taken";
+        }
         else if (!validateEmail(trim_whitespaces(field_buffer(fields[5], 0))))
         {
             errorMessage = "Please enter a valid email";
@@ -2623,7 +2657,7 @@ void renderUpdatePersonalPatientScreen()
 
     while (!done)
     {
-        while ((ch = getch()) != '\n')
+        while ((ch = readKey(stdscr)) != '\n')
         {
             driver_form(
                 ch,       // Capture key press
@@ -2793,7 +2827,7 @@ void renderUpdateSelectionPatientScreen()
         wrefresh(win_form); // Refresh win_form to display the updated menu
 
         // Handle user input
-        int ch = wgetch(win_form);
+        int ch = readKey(win_form);
         switch (ch)
         {
         case KEY_UP:
@@ -2815,6 +2849,9 @@ void renderUpdateSelectionPatientScreen()
         case 10: // Enter key confirms selection and exits
             done = true;
             break;
+        case 27: // Escape key exits the application
+            exitHandler(nullptr, nullptr, windows);
+            break;
         case 2: // Custom key for "Back"
             navigationHandler(nullptr, nullptr, windows, Screen::UpdatePersonalPatientScreen);
             break;
@@ -2954,7 +2991,7 @@ void renderUpdateAdminScreen()
     // Loop to handle user input
     while (!done)
     {
-        while ((ch = getch()) != '\n') // Wait for 'Enter' key to submit
+        while ((ch = readKey(stdscr)) != '\n') // Wait for 'Enter' key to submit
         {
             driver_form(ch, form, fields, win_form, win_body, [&]()
                         { exitHandler(form, fields, windows); }, [&]()
@@ -2970,6 +3007,10 @@ void renderUpdateAdminScreen()
         {
             errorMessage = "Please fill all required fields";
         }
+        else if (UserManager::getInstance().isUsernameTaken(trim_whitespaces(field_buffer(fields[1], 0)), u.user->getId()))
+        {
+            errorMessage = "Username is already taken";
+        }
         else if (!validateEmail(trim_whitespaces(field_buffer(fields[7], 0))))
         {
             errorMessage = "Please enter a valid email";
@@ -2,7 +2,8 @@
 
 std::string generateUUID()
 {
-    UUIDv4::UUIDGenerator<std::mt19937_64> uuidGenerator;
+    // Seeding the generator reads std::random_device, so each thread seeds it once and reuses it
+    thread_local UUIDv4::UUIDGenerator<std::mt19937_64> uuidGenerator;
     UUIDv4::UUID uuid = uuidGenerator.getUUID();
     return std::string(uuid.str());
 };
@@ -17,6 +18,64 @@ std::string formatTimestamp(std::chrono::system_clock::time_point timePoint)
     return oss.str();
 }
 
+// Number of days in a month (1-12) of a Gregorian year
+static int daysInMonth(int year, int month)
+{
+    static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return month == 2 && leap ? 29 : days[month - 1];
+}
+
+std::chrono::system_clock::time_point parseTimestamp(const std::string &timestamp)
+{
+    std::tm tm = {};
+
+    // Fast path for the zero-padded "YYYY-MM-DD HH:MM:SS" form that formatTimestamp writes
+    auto digits = [&timestamp](size_t pos, size_t count)
+    {
+        int value = 0;
+        for (size_t i = pos; i < pos + count; ++i)
+        {
+            if (timestamp[i] < '0' || timestamp[i] > '9')
+                return -1;
+            value = value * 10 + (timestamp[i] - '0');
+        }
+        return value;
+    };
+    if (timestamp.size() == 19 && timestamp[4] == '-' && timestamp[7] == '-' && timestamp[10] == ' ' &&
+        timestamp[13] == ':' && timestamp[16] == ':')
+    {
+        int year = digits(0, 4), month = digits(5, 2), day = digits(8, 2);
+        int hour = digits(11, 2), minute = digits(14, 2), second = digits(17, 2);
+        if (year >= 0 && month >= 1 && month <= 12 && day >= 1 && day <= daysInMonth(year, month) &&
+            hour >= 0 && hour <= 23 && minute >= 0 && minute <= 59 && second >= 0 && second <= 60)
+        {
+            tm.tm_year = year - 1900;
+            tm.tm_mon = month - 1;
+            tm.tm_mday = day;
+            tm.tm_hour = hour;
+            tm.tm_min = minute;
+            tm.tm_sec = second;
+            tm.tm_isdst = -1; // Let mktime decide, as formatTimestamp wrote local time
+            return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+        }
+    }
+
+    // Other spellings (e.g. without zero padding) are left to get_time, which checks neither the day
+    // against the month nor what follows the seconds
+    std::istringstream ss(timestamp);
+    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+
+    if (ss.fail() || ss.peek() != std::char_traits<char>::eof() ||
+        tm.tm_mday > daysInMonth(tm.tm_year + 1900, tm.tm_mon + 1))
+    {
+        throw std::invalid_argument("Invalid date format: " + timestamp);
+    }
+
+    tm.tm_isdst = -1;
+    return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+}
+
 std::vector<std::string> split(const std::string &s, char delimiter)
 {
     std::vector<std::string> tokens;